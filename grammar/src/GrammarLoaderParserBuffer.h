@@ -2,9 +2,9 @@
  * This file was generated automatically by Parser.
  * Do not edit this file manually.
  * 
- * This file was generated using Parser-1.0.0 compiled in May  9 2009 15:49:39
+ * This file was generated using Parser-1.0.0 compiled in Oct 17 2026 04:31:32
  * 
- * File created in 2009-05-16 13:29:38
+ * File created in 2026-10-17 04:34:07
  *****************************************************************************/
 
 #ifndef GRAMMARLOADERPARSERBUFFER_H
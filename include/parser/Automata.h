@@ -1,9 +1,12 @@
 #ifndef PARSER_AUTOMATA_H
 #define PARSER_AUTOMATA_H
 
+#include "parser/ParserDefs.h"
+
 #include <cassert>
 #include <map>
 #include <ostream>
+#include <stdint.h>
 #include <vector>
 
 class DynamicAutomata;
@@ -12,9 +15,21 @@ class DynamicAutomata;
  * @class Automata
  * 
  * Class that represent an Automata.
- * This class uses a table of ints to store the automatas transitions.
  * The automata must be deterministic and cannot have epsilon transitions.
  * 
+ * The input characters are grouped in classes: characters that have the same
+ * transitions in every state share the same class, so the table has one column
+ * for each class instead of one column for each of the ALPHABET_SIZE characters.
+ * Usually a scanner automata has only a few dozens of classes.
+ * 
+ * The transitions are stored in a single block of memory with one row for each
+ * state. The first entry of a row tells if the state is final (and the value
+ * of the state, the Scanner stores the recognized token there), the other
+ * entries are the transitions of each class. The entries use 8 bits when the
+ * values allow it, 16 or 32 bits otherwise, and the rows are padded so a row
+ * never crosses more cache lines than needed. A step of the automata reads
+ * only one row.
+ * 
  * This class shouldn't be used to make automata operations.
  * If you are working with the automata (changing it, doing automata operations),
  * you should use DynamicAutomata instead and after you are done with it you can convert
@@ -30,6 +45,17 @@ class Automata {
 	public:
 		typedef std::map<unsigned int, unsigned int> StateToState;
 		
+		// the values stored in the table entries
+		enum TableEntry {
+			// transition entries store the target state + 1
+			NO_TRANSITION = 0,
+			
+			// the first entry of each row stores the value of the state + FINAL_VALUE
+			NOT_FINAL = 0,
+			FINAL_WITHOUT_VALUE = 1,
+			FINAL_VALUE = 2
+		};
+		
 		/**
 		 * Construct an Automata with <code>size</code> states.
 		 * 
@@ -38,46 +64,87 @@ class Automata {
 		Automata(unsigned int size);
 		
 		/**
-		 * Construct an Automata with specified transition table.
-		 * See the method getTransition() table for the format documentation.
+		 * Construct an Automata with specified transition table, with one row
+		 * for each input character. The characters are grouped in classes.
+		 * 
+		 * The rows represent the input. The rows count should be always ALPHABET_SIZE.
+		 * The columns represent the current state. The columns count should  be always the number of states.
+		 * The value in <code>transitions[input][state]</code> should be the target state of the transition
+		 * or -1 if this transition does not exist.
 		 * 
 		 * @param transitions The transitions of the automata, the automata
 		 * will make a copy, leaving it unchanged.
 		 * @param size The number of states of the Automata.
-		 * 
-		 * @see getTransitionTable
 		 */
 		Automata(const int * const *transitions, unsigned int size);
-		virtual ~Automata();
 		
 		/**
-		 * Set the transitions of Automata.
-		 * See the method getTransition() table for the format documentation.
-		 * 
-		 * The transitions must have the same number of states as the Automata.
-		 * 
-		 * @param transitions The transitions of the automata, the automata
-		 * will make a copy, leaving it unchanged.
+		 * Construct an Automata with specified input classes and transition table.
+		 * The table has the format of getTransitionTable(), but the rows are
+		 * not padded: each row has <code>classes + 1</code> entries.
 		 * 
-		 * @see getTransitionTable
+		 * @param inputClasses The class of each input character, ALPHABET_SIZE values.
+		 * @param table The rows of the automata, the automata will make a copy, leaving it unchanged.
+		 * @param entrySize The size of the entries of the table, 1, 2 or 4 bytes.
+		 * @param classes The number of classes.
+		 * @param size The number of states of the Automata.
 		 */
-		void setTransitionTable(const int * const *transitions);
+		Automata(const unsigned char *inputClasses, const void *table, unsigned int entrySize,
+				unsigned int classes, unsigned int size);
+		virtual ~Automata();
 		
 		/**
 		 * Get the transitions of the Automata.
 		 * 
-		 * The transitions are stored in an matrix (an array of arrays).
-		 * The rows represent the input. The rows count should be always ALPHABET_SIZE.
-		 * The columns represent the current state. The columns count should  be always the number of states.
+		 * The table has getNumStates() rows of getRowSize() entries, each entry
+		 * is an unsigned integer with getEntrySize() bytes. The row of the
+		 * state <code>s</code> starts at the entry <code>s * getRowSize()</code>.
 		 * 
-		 * The value in <code>transitions[input][state]</code> should be the target state of the transition
-		 * or -1 if this transition does not exist. The target state cannot be
-		 * greater or equal to the states count and cannot be less than -1 (the error state).
+		 * The first entry of a row is NOT_FINAL, FINAL_WITHOUT_VALUE or the
+		 * value of the final state + FINAL_VALUE. The entry
+		 * <code>1 + inputClass</code> is the target state of the transition + 1,
+		 * or NO_TRANSITION. The entries after the last class are padding.
 		 * 
-		 * @return The transitions table. The returned matrix is not a copy
+		 * @return The transitions table, aligned to a cache line. The returned table is not a copy
 		 * and should not be changed or deleted.
+		 * 
+		 * @see getInputClasses
+		 */
+		const void *getTransitionTable() const;
+		
+		/**
+		 * @return The number of entries of each row of the transitions table.
 		 */
-		const int * const *getTransitionTable() const;
+		unsigned int getRowSize() const;
+		
+		/**
+		 * @return The size in bytes of the entries of the transitions table, 1, 2 or 4.
+		 */
+		unsigned int getEntrySize() const;
+		
+		/**
+		 * Get the class of each input character, the column of the
+		 * transition table used for the character.
+		 * 
+		 * @return An array with ALPHABET_SIZE classes, indexed by the
+		 * character as an unsigned char. The returned array is not a copy
+		 * and should not be changed or deleted.
+		 */
+		const unsigned char *getInputClasses() const;
+		
+		/**
+		 * @return The number of input classes.
+		 */
+		unsigned int getNumClasses() const;
+		
+		/**
+		 * Merge the input classes that have the same transitions in every state.
+		 * 
+		 * setTransition() splits a class when only some of its characters change,
+		 * this method should be called after all the transitions are set.
+		 * The classes are numbered by their first character.
+		 */
+		void compressAlphabet();
 		
 		/**
 		 * @return The states count of this Automata.
@@ -93,9 +160,7 @@ class Automata {
 		 */
 		inline int getTransition(unsigned int currentState, char input) const {
 			assert(currentState < numStates);
-			assert(input >= 0);
-			
-			return transitionTable[(int)input][currentState];
+			return (int)getEntry(currentState * rowSize + 1 + inputClasses[(unsigned char)input]) - 1;
 		}
 		
 		/**
@@ -110,7 +175,10 @@ class Automata {
 		/**
 		 * @return True if <code>state</code> is a final state.
 		 */
-		bool isFinalState(unsigned int state) const;
+		inline bool isFinalState(unsigned int state) const {
+			assert(state < numStates);
+			return getEntry(state * rowSize) != NOT_FINAL;
+		}
 		
 		/**
 		 * Set a final state.
@@ -126,6 +194,22 @@ class Automata {
 		 */
 		void setFinalStates(const std::vector<unsigned int> & stateList);
 		
+		/**
+		 * @param state A state of the automata.
+		 * 
+		 * @return The value of the final state or -1 if the state isn't final
+		 * or has no value.
+		 */
+		int getFinalStateValue(unsigned int state) const;
+		
+		/**
+		 * Set a final state with a value, stored in the row of the state.
+		 * 
+		 * @param state The state that will be set as a final state.
+		 * @param value The value of the state.
+		 */
+		void setFinalStateValue(unsigned int state, unsigned int value);
+		
 		/**
 		 * @return True if this Automata accept the input string.
 		 */
@@ -153,12 +237,39 @@ class Automata {
 		friend std::ostream & operator<<(std::ostream & stream, const Automata & automata);
 		
 	protected:
-		void createStates();
+		static inline unsigned int getEntry(const void *table, unsigned int entrySize, unsigned int index) {
+			switch (entrySize) {
+				case 1:
+					return ((const uint8_t *)table)[index];
+				case 2:
+					return ((const uint16_t *)table)[index];
+				default:
+					return ((const uint32_t *)table)[index];
+			}
+		}
+		
+		inline unsigned int getEntry(unsigned int index) const {
+			return getEntry(table, entrySize, index);
+		}
+		
+		void setEntry(unsigned int index, unsigned int value);
+		
+		// move the table to a new block, where the new class i is the old class columns[i]
+		// there will be room for classCapacity classes in each row
+		void layoutTable(const std::vector<unsigned int> & columns, unsigned int classCapacity,
+				unsigned int newEntrySize);
+		
+		// the class of input is changed to a new class, with the same transitions
+		unsigned int splitClass(unsigned char input);
 		
 		unsigned int numStates;
-		int **transitionTable;
+		unsigned int numClasses;
+		
+		unsigned char inputClasses[ALPHABET_SIZE];
 		
-		bool *finalStates;
+		void *table;
+		unsigned int rowSize;
+		unsigned int entrySize;
 };
 
 #endif
@@ -294,6 +294,23 @@ class DynamicAutomata {
 		void minimize(StateToState & oldStateToNewState, StateList & oldStates,
 				bool finalMerge);
 		
+		/**
+		 * Minimize this DynamicAutomata.
+		 * Only the final states in the same class can be merged. This is useful
+		 * when the final states with the same semantic (recognize the same token,
+		 * for example) can be merged.
+		 * 
+		 * The automata must be deterministic and cannot have any unreachable states.
+		 * 
+		 * @param oldStateToNewState A map of the old states of this automata to the new
+		 * state that replace the old one.
+		 * @param oldStates A list with the old states.
+		 * @param finalClasses The classes of the final states, each final state
+		 * must be in one class.
+		 */
+		void minimize(StateToState & oldStateToNewState, StateList & oldStates,
+				const StateSetList & finalClasses);
+		
 		/**
 		 * Make this automata an empty automata, rejecting all sentences.
 		 */
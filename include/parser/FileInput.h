@@ -39,6 +39,7 @@ class FileInput : public Input {
 		/**
 		 * Construct a FileInput that reads from the specified file pointer.
 		 * The file pointer will be closed in the destructor of this class.
+		 * The file must be seekable, StreamInput can read from pipes.
 		 * The default input name will be used.
 		 * 
 		 * @param fp The file pointer used to read the input.
@@ -50,15 +51,43 @@ class FileInput : public Input {
 		
 		virtual void setInputPos(unsigned int pos);
 		
+		/**
+		 * Read the file ahead of the position being used.
+		 * While a block is used, the operating system is asked to read the
+		 * next blocks in the background, so the next reads don't wait for
+		 * the disk. Files that don't have a file descriptor are only read
+		 * in blocks of the new size.
+		 * 
+		 * @param blockSize How many characters are read from the file at once.
+		 * @param queueDepth How many blocks after the current one are read in
+		 * advance, 0 disables the read ahead.
+		 */
+		void setReadAhead(unsigned int blockSize, unsigned int queueDepth);
+		
 	protected:
-		virtual char readChar();
+		virtual bool fetchBuffer();
 		
 	private:
+		// read the buffer starting at pos
+		void loadBuffer(unsigned int pos);
+		
+		// ask the operating system to read the next blocks
+		void adviseReadAhead();
+		
 		FILE *filePointer;
 		
 		char *buffer;
-		unsigned int bufPos;
 		unsigned int bufSize;
+		unsigned int bufCapacity;
+		
+		unsigned int readAheadBlock;
+		unsigned int readAheadDepth;
+		
+		// the end of the characters already requested to the operating system
+		unsigned int adviseEnd;
+		
+		// the input position of the first character in the buffer
+		unsigned int bufferPos;
 };
 
 #endif
@@ -25,7 +25,7 @@ class GrammarLoaderLoader {
 		TokenTypeID scannerRegexId;
 		TokenTypeID scannerRuleEndId;
 		TokenTypeID scannerWhiteSpaceId;
-
+		
 		/*****************************************************************************
 		 * Parser Tokens
 		 *****************************************************************************/
@@ -38,6 +38,8 @@ class GrammarLoaderLoader {
 		TokenTypeID parserWhitespaceId;
 		
 	private:
+		static void createGrammarLoaderLoader();
+		
 		static Pointer<GrammarLoaderLoader> grammarLoaderLoader;
 };
 
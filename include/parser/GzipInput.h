@@ -0,0 +1,62 @@
+#ifndef PARSER_GZIP_INPUT_H
+#define PARSER_GZIP_INPUT_H
+
+#include "parser/StreamInput.h"
+
+#include <zlib.h>
+
+/**
+ * @class GzipInput
+ * 
+ * Input implementation which reads a gzip compressed file.
+ * 
+ * The file is decompressed while it's read, into the ring buffer of
+ * StreamInput, so the rollbacks have the same limits of a StreamInput.
+ * Files that are not compressed are read as they are.
+ * 
+ * @author Felipe Borges Alves
+ */
+class GzipInput : public StreamInput {
+	public:
+		/**
+		 * Construct a GzipInput that reads from the file with the path
+		 * <code>file</code>.
+		 * The path will also be used as the input name.
+		 * 
+		 * @param file The path of the file.
+		 * 
+		 * @throw IOError If an error occur while opening the file.
+		 */
+		GzipInput(const std::string & file);
+		
+		/**
+		 * Construct a GzipInput that reads from the file with the path
+		 * <code>file</code>.
+		 * The path will also be used as the input name.
+		 * 
+		 * @param file The path of the file.
+		 * 
+		 * @throw IOError If an error occur while opening the file.
+		 */
+		GzipInput(const char *file);
+		
+		/**
+		 * Construct a GzipInput that reads from a file descriptor, like a pipe.
+		 * The file descriptor will be closed in the destructor of this class.
+		 * The default input name will be used.
+		 * 
+		 * @param fd The file descriptor used to read the input.
+		 * 
+		 * @throw IOError If an error occur while opening the file descriptor.
+		 */
+		GzipInput(int fd);
+		virtual ~GzipInput();
+		
+	protected:
+		virtual unsigned int readStream(char *buf, unsigned int size);
+		
+	private:
+		gzFile file;
+};
+
+#endif
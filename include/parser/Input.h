@@ -4,6 +4,7 @@
 #include "parser/InputLocation.h"
 
 #include <cassert>
+#include <deque>
 #include <ostream>
 #include <string>
 
@@ -31,19 +32,50 @@ class Input {
 		virtual ~Input();
 		
 		/**
-		 * @return The next character in the input.
-		 * 
-		 * @TODO This method is slow, it must be optimized.
+		 * @return The next character in the input or '\0' if the end of the
+		 * input was reached.
 		 */
 		inline char nextChar() {
-			char c = readChar();
+			if (bufferCurrent >= bufferEnd && !nextBuffer()) return '\0';
 			
-			if (c == '\n') {
-				++inputLine;
-				lastLinePos = inputPos;
-			}
+			++inputPos;
+			return *bufferCurrent++;
+		}
+		
+		/**
+		 * Get the characters of this input that are already in memory,
+		 * starting at the current position.
+		 * 
+		 * The characters can be read directly from the buffer, without a
+		 * virtual call for each character. The input position does not change
+		 * until consumeBuffer() is called.
+		 * The buffer is valid until the next call to any non const method of this
+		 * input other than consumeBuffer(), so the consumed characters can still
+		 * be read until getBuffer() is called again.
+		 * 
+		 * @param buf A pointer where the start of the buffer will be stored.
+		 * 
+		 * @return The number of characters in the buffer or 0 if the end of the
+		 * input was reached.
+		 */
+		inline unsigned int getBuffer(const char *& buf) {
+			if (bufferCurrent >= bufferEnd && !nextBuffer()) return 0;
 			
-			return c;
+			buf = bufferCurrent;
+			return bufferEnd - bufferCurrent;
+		}
+		
+		/**
+		 * Advance the input position over characters returned by getBuffer().
+		 * 
+		 * @param count How many characters of the buffer were used, it cannot
+		 * be greater than the size returned by getBuffer().
+		 */
+		inline void consumeBuffer(unsigned int count) {
+			assert(count <= (unsigned int)(bufferEnd - bufferCurrent));
+			
+			bufferCurrent += count;
+			inputPos += count;
 		}
 		
 		/**
@@ -121,24 +153,104 @@ class Input {
 		
 		/**
 		 * Change the current position of this Input.
+		 * The lines of characters skipped without being read are not counted.
 		 * 
 		 * @param pos The new position.
 		 */
 		virtual void setInputPos(unsigned int pos) = 0;
 		
 	protected:
-		virtual char readChar() = 0;
+		/**
+		 * Fill the buffer window (bufferCurrent and bufferEnd) with the characters
+		 * starting at the current position.
+		 * This method is called only when all characters of the window were used.
+		 * 
+		 * @return False if the end of the input was reached.
+		 */
+		virtual bool fetchBuffer() = 0;
+		
+		/**
+		 * Discard the buffer window, the next read will call fetchBuffer().
+		 */
+		void resetBuffer();
+		
+		/**
+		 * Use the buffer window of another input as the window of this input.
+		 * This is used by inputs that read from other inputs.
+		 * 
+		 * @param in The input that will supply the characters.
+		 * 
+		 * @return False if the end of <code>in</code> was reached.
+		 */
+		bool borrowBuffer(Input *in);
+		
+		/**
+		 * Advance <code>in</code> over the characters read from the window
+		 * borrowed with borrowBuffer(), so its position matches this input.
+		 * 
+		 * @param in The input the window was borrowed from.
+		 */
+		void returnBuffer(Input *in) const;
+		
+		/**
+		 * @return The position where the current line starts.
+		 */
+		unsigned int getLineStart() const;
+		
+		/**
+		 * Forget the lines that end before a position.
+		 * Inputs that cannot go back to positions already read use this to
+		 * keep the size of the line index constant.
+		 * 
+		 * @param pos The input will never be set to a position before this one.
+		 */
+		void discardLines(unsigned int pos);
+		
+		/**
+		 * Count the lines read before the position changes, the characters
+		 * skipped until the new position are not counted.
+		 * Inputs call this in setInputPos() before changing the buffer window,
+		 * since the lines are counted from the characters in the window.
+		 * 
+		 * @param pos The new position.
+		 */
+		void seekLines(unsigned int pos);
 		
 		std::string inputName;
 		
 		// the position of the input
 		unsigned int inputPos;
-		unsigned int inputLine;
-		unsigned int lastLinePos;
-		
 		unsigned int markedPos;
-		unsigned int markedLine;
-		unsigned int markedLastLinePos;
+		
+		// the characters in memory, bufferCurrent is the character at inputPos
+		const char *bufferCurrent;
+		const char *bufferEnd;
+		
+	private:
+		// count the lines of the window before the current position, then fetch
+		// the next window
+		bool nextBuffer();
+		
+		// find the new lines between indexedPos and the current position, the
+		// characters must still be in the buffer window
+		void indexLines() const;
+		
+		// the index of the line that contains pos in lineStarts
+		unsigned int findLine(unsigned int pos) const;
+		
+		// start of the borrowed window not yet returned
+		mutable const char *borrowedPos;
+		
+		// the start position of each line, the lines are found only when a
+		// line is asked for or the characters are leaving the buffer window
+		mutable std::deque<unsigned int> lineStarts;
+		unsigned int discardedLines;
+		
+		// the characters before indexedPos were searched for new lines
+		mutable unsigned int indexedPos;
+		
+		// the last line found, the lines are usually asked in order
+		mutable unsigned int lastLine;
 };
 
 #endif
@@ -0,0 +1,119 @@
+#ifndef PARSER_KEYWORD_TABLE_H
+#define PARSER_KEYWORD_TABLE_H
+
+#include "parser/TokenType.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @class KeywordTable
+ * 
+ * The keywords of a ScannerAutomata, literal tokens like <code>while</code>
+ * that are also recognized by a more generic token like an identifier.
+ * 
+ * The keywords are not states of the automata: the automata recognizes
+ * them as the generic token, and then the characters of the token are
+ * looked up in this table. The table is a perfect hash, so a lookup hashes
+ * the characters and compares them with at most one keyword.
+ * 
+ * @author Felipe Borges Alves
+ * 
+ * @see ScannerAutomata
+ */
+class KeywordTable {
+	public:
+		KeywordTable();
+		
+		/**
+		 * Add a keyword to the table.
+		 * 
+		 * @param tokenTypeId The generic token that recognizes the keyword.
+		 * @param keyword The characters of the keyword, they can't be
+		 * already in the table.
+		 * @param keywordId The token returned for the keyword.
+		 */
+		void addKeyword(TokenTypeID tokenTypeId, const std::string & keyword, TokenTypeID keywordId);
+		
+		/**
+		 * @return The number of keywords.
+		 */
+		inline unsigned int size() const {
+			return keywords.size();
+		}
+		
+		TokenTypeID getTokenTypeId(unsigned int index) const;
+		const std::string & getKeyword(unsigned int index) const;
+		TokenTypeID getKeywordId(unsigned int index) const;
+		
+		/**
+		 * @return False if a token can't be a keyword, without looking at its characters.
+		 */
+		inline bool mayBeKeyword(TokenTypeID tokenTypeId, unsigned int length) const {
+			return length >= minLength && length <= maxLength && tokenTypeId < generic.size()
+					&& generic[tokenTypeId];
+		}
+		
+		/**
+		 * Find the token of the characters of a generic token.
+		 * 
+		 * @param tokenTypeId The token recognized by the automata.
+		 * @param chars The characters of the token.
+		 * @param length The number of characters.
+		 * 
+		 * @return The id of the keyword or <code>tokenTypeId</code> if the
+		 * characters are not a keyword.
+		 */
+		inline TokenTypeID classify(TokenTypeID tokenTypeId, const char *chars,
+				unsigned int length) const {
+				
+			if (!mayBeKeyword(tokenTypeId, length)) return tokenTypeId;
+			
+			int index = slots[hash(seed, chars, length) & mask];
+			if (index == -1) return tokenTypeId;
+			
+			const Keyword & keyword = keywords[index];
+			if (keyword.tokenTypeId != tokenTypeId || keyword.keyword.size() != length) return tokenTypeId;
+			if (memcmp(keyword.keyword.data(), chars, length)) return tokenTypeId;
+			
+			return keyword.keywordId;
+		}
+		
+		// check if this KeywordTable is in a consistent state
+		void sanityCheck() const;
+		
+		bool operator==(const KeywordTable & table) const;
+		bool operator!=(const KeywordTable & table) const;
+		
+	private:
+		struct Keyword {
+			TokenTypeID tokenTypeId;
+			std::string keyword;
+			TokenTypeID keywordId;
+		};
+		
+		static inline unsigned int hash(unsigned int seed, const char *chars, unsigned int length) {
+			unsigned int h = seed;
+			for (unsigned int i = 0; i < length; ++i) h = (h ^ (unsigned char)chars[i]) * 16777619;
+			return h ^ (h >> 15);
+		}
+		
+		// find a seed without collisions, growing the table if needed
+		void buildHash();
+		
+		std::vector<Keyword> keywords;
+		
+		// the index of the keyword in each slot or -1
+		std::vector<int> slots;
+		unsigned int mask;
+		unsigned int seed;
+		
+		unsigned int minLength;
+		unsigned int maxLength;
+		
+		// the tokens that can be keywords
+		std::vector<bool> generic;
+};
+
+#endif
@@ -20,7 +20,7 @@ class MemoryInput : public Input {
 		virtual void sanityCheck() const;
 		
 	protected:
-		virtual char readChar();
+		virtual bool fetchBuffer();
 		
 		char *buffer;
 		unsigned int bufSize;
@@ -0,0 +1,69 @@
+#ifndef PARSER_MMAP_INPUT_H
+#define PARSER_MMAP_INPUT_H
+
+#include "parser/Input.h"
+
+/**
+ * @class MmapInput
+ * 
+ * Input implementation which maps a whole file in memory (read only).
+ * The characters are read directly from the mapping, so there are no
+ * system calls or copies while reading, repositioning or rolling back.
+ * 
+ * @author Felipe Borges Alves
+ */
+class MmapInput : public Input {
+	public:
+		/**
+		 * Construct a MmapInput that maps the file with the path
+		 * <code>file</code>.
+		 * The path will also be used as the input name.
+		 * 
+		 * @param file The path of the file.
+		 * 
+		 * @throw IOError If an error occur while opening or mapping the file.
+		 */
+		MmapInput(const std::string & file);
+		
+		/**
+		 * Construct a MmapInput that maps the file with the path
+		 * <code>file</code>.
+		 * The path will also be used as the input name.
+		 * 
+		 * @param file The path of the file.
+		 * 
+		 * @throw IOError If an error occur while opening or mapping the file.
+		 */
+		MmapInput(const char *file);
+		virtual ~MmapInput();
+		
+		/**
+		 * @return The mapped file. The characters of a token are at
+		 * <code>getData() + token->getInputPos()</code>, so they can be
+		 * used without being copied.
+		 * The pointer is valid while this input exists.
+		 */
+		const char *getData() const;
+		
+		/**
+		 * @return The size of the mapped file.
+		 */
+		unsigned int getDataSize() const;
+		
+		virtual std::string getCurrentLine();
+		
+		virtual void setInputPos(unsigned int pos);
+		
+		virtual void sanityCheck() const;
+		
+	protected:
+		virtual bool fetchBuffer();
+		
+	private:
+		void mapFile(const char *file);
+		
+		const char *data;
+		unsigned int dataSize;
+};
+
+#endif
@@ -3,6 +3,19 @@
 
 #include "parser/Input.h"
 
+#include <vector>
+
+/**
+ * @class MultInput
+ * 
+ * Input that reads from a sequence of inputs.
+ * 
+ * When an input ends, the characters read from it since the marked position
+ * are copied to a stitch buffer, so a rollback can go back to the previous
+ * input and tokens can continue from one input to the next one.
+ * 
+ * @author Felipe Borges Alves
+ */
 class MultInput : public Input {
 	public:
 		MultInput();
@@ -10,6 +23,8 @@ class MultInput : public Input {
 		
 		virtual Input *currentInput() const = 0;
 		
+		virtual void resetInput();
+		
 		virtual InputLocation getCurrentLocation() const;
 		
 		virtual const std::string & getInputName() const;
@@ -21,17 +36,45 @@ class MultInput : public Input {
 		virtual unsigned int getCurrentLinePos() const;
 		
 		virtual void markPosition();
-		virtual void rollback(unsigned int usedChars);
 		
 		void setInputPos(unsigned int pos);
 		
 	protected:
-		virtual char readChar();
+		virtual bool fetchBuffer();
 		
 		// return true if there is another input
+		// the previous input must still be valid after changing the input
 		virtual bool inputFinished() = 0;
 		
 		unsigned int inputOffset;
+		
+	private:
+		// where the characters of one input start in the stitch
+		struct StitchPart {
+			unsigned int pos;
+			unsigned int localPos;
+			InputLocation location;
+		};
+		
+		typedef std::vector<StitchPart> StitchParts;
+		
+		// copy the pending characters of the previous input to the stitch
+		void stitchInput(Input *previous, unsigned int previousOffset);
+		
+		// the part of the stitch that contains pos
+		StitchParts::const_iterator findStitchPart(unsigned int pos) const;
+		
+		InputLocation getStitchLocation(unsigned int pos) const;
+		
+		inline bool inStitch() const {
+			return inputPos < inputOffset;
+		}
+		
+		// the characters between stitchPos and inputOffset, from the previous inputs
+		std::string stitch;
+		unsigned int stitchPos;
+		
+		StitchParts stitchParts;
 };
 
 #endif
@@ -0,0 +1,30 @@
+#ifndef PARSER_MUTEX_LOCK_H
+#define PARSER_MUTEX_LOCK_H
+
+#include <pthread.h>
+
+/**
+ * @class MutexLock
+ * 
+ * Lock a mutex while the MutexLock is in scope.
+ * 
+ * @author Felipe Borges Alves
+ */
+class MutexLock {
+	public:
+		inline MutexLock(pthread_mutex_t & m) : mutex(m) {
+			pthread_mutex_lock(&mutex);
+		}
+		
+		inline ~MutexLock() {
+			pthread_mutex_unlock(&mutex);
+		}
+		
+	private:
+		MutexLock(const MutexLock & lock);
+		MutexLock & operator=(const MutexLock & lock);
+		
+		pthread_mutex_t & mutex;
+};
+
+#endif
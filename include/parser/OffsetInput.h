@@ -36,7 +36,7 @@ class OffsetInput : public Input {
 		virtual void setInputPos(unsigned int pos);
 		
 	protected:
-		virtual char readChar();
+		virtual bool fetchBuffer();
 		
 	private:
 		Input *input;
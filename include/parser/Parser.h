@@ -9,6 +9,7 @@
 
 class ParserAction;
 class Scanner;
+class TokenTable;
 
 /**
  * @class Parser
@@ -74,6 +75,34 @@ class Parser {
 		 */
 		virtual ParsingTree::Node *parseWithErrorRecovery(ParserErrorList & errorList);
 		
+		/**
+		 * Do the parsing of tokens already read by Scanner::tokenizeAll().
+		 * The Scanner of this Parser isn't used.
+		 * 
+		 * @param tokens The tokens of the input.
+		 * 
+		 * @return The resulting parsing tree.
+		 * 
+		 * @throw ParserError If the input has an error.
+		 * 
+		 * @see TokenTable
+		 */
+		virtual ParsingTree::Node *parse(const TokenTable & tokens);
+		
+		/**
+		 * Do the parsing of tokens already read by Scanner::tokenizeAll(),
+		 * with error recovery. The Scanner of this Parser isn't used.
+		 * 
+		 * @param tokens The tokens of the input.
+		 * @param errorList A list where the parse errors will be stored.
+		 * 
+		 * @return The resulting parsing tree or NULL if the input contains errors.
+		 * 
+		 * @see TokenTable
+		 */
+		virtual ParsingTree::Node *parseWithErrorRecovery(const TokenTable & tokens,
+				ParserErrorList & errorList);
+		
 		/**
 		 * @return The Scanner that supply tokens to this Parser.
 		 */
@@ -3,10 +3,11 @@
 
 const char * const VERSION = "1.0.0";
 
-// the alphabet is always the 128 ASCii characters (including NIL)
-const unsigned int ALPHABET_SIZE = 128;
+// the alphabet is always the 256 byte values (including NIL), so UTF-8 and
+// other 8 bit encodings can be scanned byte by byte
+const unsigned int ALPHABET_SIZE = 256;
 
-// epsilon must be a unsigned int value that does not fit in the ASCii (including nil) charset
+// epsilon must be a unsigned int value that does not fit in the alphabet (including nil)
 const unsigned int EPSILON = 0x7FFFFFFF;
 
 // the symbol $, that represent the end of the input
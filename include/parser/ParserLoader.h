@@ -24,6 +24,8 @@ class ParserLoader {
 		 * The buffer must be a buffer previously generated by automataToBuffer method.
 		 * There is no need to specify the size of the buffer, since the buffer it'self
 		 * know his size.
+		 * Buffers saved before the input classes, with transitions only for
+		 * the 128 ASCii characters, are still loaded.
 		 * 
 		 * @param buffer The buffer holding the ScannerAutomata.
 		 * 
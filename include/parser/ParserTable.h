@@ -11,12 +11,17 @@
 
 class ParserAction;
 class Scanner;
+class TokenTable;
 
 /**
  * @class ParserTable
  * 
  * This class holds the parsing table used during the parsing.
  * 
+ * The table isn't changed by the parsing, all the state of a parse is kept
+ * by the parse methods, so several threads can parse with the same table,
+ * shared by a Pointer<ParserTable>, each one with its own Parser.
+ * 
  * @author Felipe Borges Alves
  */
 class ParserTable {
@@ -121,6 +126,33 @@ class ParserTable {
 		virtual Node *parseWithErrorRecovery(Scanner *scanner, ParserAction *parserAction,
 				ParserErrorList & errorList) const = 0;
 		
+		/**
+		 * Do the parsing of tokens already read.
+		 * Do not use this method directly, use Parser::parse(const TokenTable &) instead.
+		 * 
+		 * @param tokens The tokens of the input.
+		 * @param action The action to be called each non-terminal recognition.
+		 * 
+		 * @return The resulting parsing tree.
+		 * 
+		 * @throw ParserError If the input has an error.
+		 */
+		virtual Node *parse(const TokenTable & tokens, ParserAction *action) const = 0;
+		
+		/**
+		 * Do the parsing of tokens already read, with error recovery.
+		 * Do not use this method directly, use
+		 * Parser::parseWithErrorRecovery(const TokenTable &, ParserErrorList &) instead.
+		 * 
+		 * @param tokens The tokens of the input.
+		 * @param action The action to be called each non-terminal recognition.
+		 * @param errorList A list where the parse errors will be stored.
+		 * 
+		 * @return The resulting parsing tree or NULL if the input contains errors.
+		 */
+		virtual Node *parseWithErrorRecovery(const TokenTable & tokens, ParserAction *parserAction,
+				ParserErrorList & errorList) const = 0;
+		
 		virtual bool operator==(const ParserTable & table) const = 0;
 		bool operator!=(const ParserTable & table) const;
 		
@@ -129,6 +161,25 @@ class ParserTable {
 		virtual void printTable(std::ostream & stream) const = 0;
 		
 	protected:
+		// supply the tokens to the parsing, from a Scanner or from a TokenTable
+		class TokenReader {
+			public:
+				TokenReader(Scanner *scan);
+				TokenReader(const TokenTable *table);
+				
+				// return the next token or NULL at the end of the input
+				Token *nextToken();
+				
+				// an error at the last token returned
+				ParserError createError(const std::string & msg) const;
+				
+			private:
+				Scanner *scanner;
+				
+				const TokenTable *tokens;
+				unsigned int index;
+		};
+		
 		NonTerminalID rootNonTerminalId;
 };
 
@@ -51,6 +51,11 @@ class ParserTableLL1 : public ParserTable {
 		virtual Node *parseWithErrorRecovery(Scanner *scanner, ParserAction *parserAction,
 				ParserErrorList & errorList) const;
 		
+		virtual Node *parse(const TokenTable & tokens, ParserAction *action) const;
+		
+		virtual Node *parseWithErrorRecovery(const TokenTable & tokens, ParserAction *parserAction,
+				ParserErrorList & errorList) const;
+		
 		virtual bool operator==(const ParserTable & table) const;
 		bool operator==(const ParserTableLL1 & table) const;
 		bool operator!=(const ParserTableLL1 & table) const;
@@ -62,7 +67,7 @@ class ParserTableLL1 : public ParserTable {
 		// errors will be added to the list and no exception will be thrown
 		// If errorList is NULL than the parsing is without error recovery,
 		// an exception will be thrown in the first error
-		Node *parse(Scanner *scanner, ParserAction *action,
+		Node *parse(TokenReader & reader, ParserAction *action,
 				ParserErrorList *errorList) const;
 		
 		Rule *getRule(NonTerminal *stackTop, Token *nextToken) const;
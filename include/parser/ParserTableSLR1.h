@@ -97,6 +97,11 @@ class ParserTableSLR1 : public ParserTable {
 		virtual Node *parseWithErrorRecovery(Scanner *scanner, ParserAction *parserAction,
 				ParserErrorList & errorList) const;
 		
+		virtual Node *parse(const TokenTable & tokens, ParserAction *parserAction) const;
+		
+		virtual Node *parseWithErrorRecovery(const TokenTable & tokens, ParserAction *parserAction,
+				ParserErrorList & errorList) const;
+		
 		virtual void printTable(std::ostream & stream) const;
 		
 		virtual bool operator==(const ParserTable & table) const;
@@ -108,7 +113,7 @@ class ParserTableSLR1 : public ParserTable {
 		// errors will be added to the list and no exception will be thrown
 		// If errorList is NULL than the parsing is without error recovery,
 		// an exception will be thrown in the first error
-		Node *parse(Scanner *scanner, ParserAction *parserAction,
+		Node *parse(TokenReader & reader, ParserAction *parserAction,
 				ParserErrorList *errorList) const;
 		
 		const Action & getAction(State state, Token *tok) const;
@@ -96,12 +96,28 @@ class ParsingTree {
 			public:
 				Token(TokenTypeID id);
 				Token(TokenTypeID id, const std::string & tok, const InputLocation & location);
+				Token(TokenTypeID id, const std::string & tok, const InputLocation & location,
+						unsigned int pos);
+				
+				// a token with the text of a TokenPool, the pool must exist while the token is used
+				Token(TokenTypeID id, const std::string *pooledTok, const InputLocation & location,
+						unsigned int pos);
+				
+				Token(const Token & other);
+				virtual ~Token();
 				
 				TokenTypeID getTokenTypeId() const;
 				
 				const std::string & getToken() const;
 				void setToken(const std::string & tok);
 				
+				// the string of the TokenPool with the text of this token, or NULL
+				// if this token has its own text
+				const std::string *getPooledToken() const;
+				
+				// the position of the first character of this token in the input
+				unsigned int getInputPos() const;
+				
 				virtual bool hasInputLocation() const;
 				
 				virtual InputLocation getInputLocation() const;
@@ -111,9 +127,13 @@ class ParsingTree {
 			private:
 				TokenTypeID tokenTypeId;
 				
-				std::string token;
+				// the text of this token, owned by it or in a TokenPool
+				const std::string *token;
+				bool ownToken;
 				
 				InputLocation inputLocation;
+				
+				unsigned int inputPos;
 		};
 		
 		
@@ -10,6 +10,13 @@
  * 
  * A SmartPointer with reference counting.
  * 
+ * The reference counter is changed with atomic operations, so copies of a
+ * Pointer can be used and destroyed by different threads. A single Pointer
+ * object must not be changed by a thread while other thread uses it.
+ * Programs that don't share Pointers between threads may define
+ * PARSER_NON_ATOMIC_POINTER when building libparser and their code, to
+ * use plain increments.
+ * 
  * @author Felipe Borges Alves
  */
 template<class T>
@@ -116,7 +123,7 @@ class Pointer {
 		 * Mark this pointer to not be deleted.
 		 */
 		inline void doNotDelete() {
-			if (this->references) ++*this->references;
+			if (this->references) incrementReferences(this->references);
 		}
 		
 		/**
@@ -221,11 +228,28 @@ class Pointer {
 		}
 		
 	private:
+		static inline void incrementReferences(int *ref) {
+#ifdef PARSER_NON_ATOMIC_POINTER
+			++*ref;
+#else
+			__sync_add_and_fetch(ref, 1);
+#endif
+		}
+		
+		// return the references left
+		static inline int decrementReferences(int *ref) {
+#ifdef PARSER_NON_ATOMIC_POINTER
+			return --*ref;
+#else
+			return __sync_sub_and_fetch(ref, 1);
+#endif
+		}
+		
 		inline void increment(T *p, int *ref) {
 			this->ptr = p;
 			if (this->ptr) {
 				this->references = ref;
-				++*this->references;
+				incrementReferences(this->references);
 			}
 			else this->references = NULL;
 		}
@@ -238,7 +262,7 @@ class Pointer {
 		
 		inline void decrement() {
 			if (this->references) {
-				if (!--*this->references) {
+				if (!decrementReferences(this->references)) {
 					delete(this->ptr);
 					delete(this->references);
 				}
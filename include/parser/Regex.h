@@ -1,13 +1,51 @@
 #ifndef PARSER_REGEX_H
 #define PARSER_REGEX_H
 
+#include "parser/Pointer.h"
+
 #include <map>
 #include <string>
+#include <vector>
 
 class Automata;
 
+/**
+ * @class Regex
+ * 
+ * A regular expression, compiled to an Automata by the RegexCompiler.
+ * 
+ * matches() tells if a whole string is reconized by the regex, search(),
+ * findAll() and split() find the parts of a string reconized by it. A match
+ * is the leftmost one, and the longest one starting there.
+ * 
+ * The automatas of the patterns are shared by the regexes with the same
+ * pattern, see RegexCompiler::getAutomata().
+ * 
+ * The search uses the characters every match starts with, when the regex
+ * has them, to jump to the candidate positions with a memchr. Otherwise it
+ * runs an unanchored automata, reconizing <code>.*(regex)</code>, to find
+ * where the first match ends without trying every position before it. The
+ * unanchored automata is built by the first search.
+ * 
+ * A Regex isn't changed after it's constructed, except by the first search
+ * that is done while a lock is held, so it can be used by several threads.
+ * 
+ * @author Felipe Borges Alves
+ */
 class Regex {
 	public:
+		/**
+		 * @struct Match
+		 * 
+		 * The position of a match in a string.
+		 */
+		struct Match {
+			unsigned int position;
+			unsigned int length;
+		};
+		
+		typedef std::vector<Match> MatchList;
+		
 		Regex(const std::string & pattern);
 		Regex(const char *pattern);
 		Regex(Automata *autom);
@@ -18,12 +56,61 @@ class Regex {
 		
 		bool matches(const std::string & sentence) const;
 		
+		/**
+		 * Find the first match in a string.
+		 * 
+		 * @param text The string.
+		 * @param match Where the match is stored.
+		 * @param start The position where the search starts.
+		 * 
+		 * @return True if a match was found.
+		 */
+		bool search(const std::string & text, Match & match, unsigned int start = 0) const;
+		
+		/**
+		 * Find all the matches in a string, that don't overlap.
+		 * After an empty match, the next match starts one character after it.
+		 * 
+		 * @param text The string.
+		 * @param matches A list where the matches are inserted, in order.
+		 */
+		void findAll(const std::string & text, MatchList & matches) const;
+		
+		/**
+		 * Split a string by the matches of the regex. The empty matches are
+		 * not used, so the pieces are never split between two characters that
+		 * aren't matched.
+		 * 
+		 * @param text The string.
+		 * @param pieces A list where the parts of the string between the matches
+		 * are inserted, in order. There is always one more piece than matches used,
+		 * some pieces may be empty.
+		 */
+		void split(const std::string & text, MatchList & pieces) const;
+		
+		/**
+		 * @return The characters every match starts with, may be empty.
+		 */
+		const std::string & getPrefix() const;
+		
 		const Automata *getAutomata() const;
 		
 	private:
 		void compile(const char *pattern);
 		
-		Automata *automata;
+		// find the prefix and build the unanchored automata, only once
+		void prepareSearch() const;
+		void buildSearch() const;
+		
+		// the length of the longest match starting at pos, or -1
+		int matchAt(const char *text, unsigned int size, unsigned int pos) const;
+		
+		Pointer<const Automata> automata;
+		
+		// built by the first search
+		mutable int searchPrepared;
+		mutable std::string prefix;
+		mutable Automata *searchAutomata;
 };
 
 #endif
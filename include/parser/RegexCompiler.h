@@ -5,7 +5,10 @@
 #include "parser/Pointer.h"
 #include "parser/RegexCompiler.h"
 
+#include <list>
+#include <pthread.h>
 #include <map>
+#include <string>
 #include <vector>
 
 class Automata;
@@ -14,18 +17,89 @@ class ParserTable;
 class RegexGrammar;
 class ScannerAutomata;
 
+/**
+ * @class RegexCompiler
+ * 
+ * Compile the patterns of the regexes to minimized automatas.
+ * 
+ * The automatas of the patterns compiled by getAutomata() are kept in a
+ * cache, so a pattern used by many Regex objects is parsed only once. The
+ * cache keeps the patterns used last, up to getCacheSize() patterns, and its
+ * automatas are shared with the regexes, they must not be changed.
+ * 
+ * The instance returned by getInstance() is created once, and can be used by
+ * several threads: the cache is locked while it's used, the patterns are
+ * compiled without locking it.
+ * 
+ * @author Felipe Borges Alves
+ * 
+ * @see Regex
+ */
 class RegexCompiler {
 	public:
+		static const unsigned int DEFAULT_CACHE_SIZE = 256;
+		
 		RegexCompiler();
 		virtual ~RegexCompiler();
 		
 		static RegexCompiler *getInstance();
 		
+		/**
+		 * Compile a pattern, without using the cache.
+		 * 
+		 * @return A new automata for the pattern, deleted by the caller.
+		 */
 		Automata *compile(const char *pattern) const;
 		
+		/**
+		 * Get the automata of a pattern from the cache, compiling it if it
+		 * isn't there.
+		 * 
+		 * @return The automata for the pattern, shared by all its users.
+		 */
+		Pointer<const Automata> getAutomata(const std::string & pattern);
+		
+		/**
+		 * @return The number of patterns kept in the cache.
+		 */
+		unsigned int getCacheSize() const;
+		
+		/**
+		 * Set the number of patterns kept in the cache, removing the patterns
+		 * used first if the cache is bigger. Zero disables the cache.
+		 */
+		void setCacheSize(unsigned int size);
+		
+		/**
+		 * Remove all the patterns from the cache, the counters are kept.
+		 */
+		void clearCache();
+		
+		/**
+		 * @return The number of times getAutomata() found the pattern in the cache.
+		 */
+		unsigned int getCacheHits() const;
+		
+		/**
+		 * @return The number of times getAutomata() compiled the pattern.
+		 */
+		unsigned int getCacheMisses() const;
+		
 	private:
+		static void createInstance();
+		
 		static Pointer<RegexCompiler> instance;
 		
+		// the patterns in the cache, the last used first
+		typedef std::list<std::string> PatternList;
+		
+		struct CacheEntry {
+			Pointer<const Automata> automata;
+			PatternList::iterator use;
+		};
+		
+		typedef std::map<std::string, CacheEntry> AutomataCache;
+		
 		typedef ParsingTree::Node Node;
 		typedef ParsingTree::NonTerminal NonTerminal;
 		typedef ParsingTree::Token Token;
@@ -41,6 +115,10 @@ class RegexCompiler {
 			FACTOR_NONE
 		};
 		
+		// remove the patterns used first while the cache is too big,
+		// the cache must be locked
+		void removeOldPatterns();
+		
 		DynamicAutomata *getNodeAutomata(ParsingTree::Node *node) const;
 		
 		DynamicAutomata *getRegexAutomata(NonTerminal *nonTerminal) const;
@@ -78,6 +156,13 @@ class RegexCompiler {
 		Pointer<ParserTable> parserTable;
 		
 		PredefinedSet predefinedSets;
+		
+		mutable pthread_mutex_t cacheMutex;
+		AutomataCache cache;
+		PatternList cacheUses;
+		unsigned int cacheSize;
+		unsigned int cacheHits;
+		unsigned int cacheMisses;
 };
 
 #endif
@@ -5,8 +5,10 @@
 #include "parser/ParsingTree.h"
 #include "parser/Pointer.h"
 #include "parser/ScannerAutomata.h"
+#include "parser/TokenPool.h"
 
 class Input;
+class TokenTable;
 
 /**
  * @class Scanner
@@ -53,6 +55,73 @@ class Scanner {
 		 */
 		virtual ParsingTree::Token *nextToken();
 		
+		/**
+		 * Read the next tokens into an array of records.
+		 * 
+		 * No memory is allocated while reading, so this is faster than
+		 * nextToken() when the tokens are processed in batches. The
+		 * characters of the tokens are not copied.
+		 * 
+		 * @param records Where the tokens will be stored.
+		 * @param size The size of <code>records</code>.
+		 * @param locations If the line and column of each token should be stored.
+		 * Finding the locations makes the scanner slower.
+		 * 
+		 * @return How many tokens were read. It's less than <code>size</code>
+		 * only when the end of the input was reached.
+		 * 
+		 * @see TokenRecord
+		 */
+		unsigned int nextTokens(TokenRecord *records, unsigned int size, bool locations);
+		
+		/**
+		 * Read all the tokens of an input to a TokenTable.
+		 * 
+		 * The characters in memory are scanned in a single loop, so this is
+		 * the fastest way to read a MemoryInput or a MmapInput. The ignored
+		 * tokens are not stored in the table.
+		 * 
+		 * @param in The Input that will be read until the end. It isn't the
+		 * input of this Scanner and it will not be deleted.
+		 * @param tokens Where the tokens will be stored, the previous tokens are removed.
+		 * @param numThreads The maximum number of threads used. Large inputs
+		 * are split in chunks tokenized at the same time, the tokens are the
+		 * same as the ones read by a single thread. Only a MemoryInput or a
+		 * MmapInput are split, other inputs are read by a single thread.
+		 * 
+		 * @throw ParserError If the input has an invalid token.
+		 * 
+		 * @see TokenTable
+		 */
+		void tokenizeAll(Input *in, TokenTable & tokens, unsigned int numThreads = 1) const;
+		
+		/**
+		 * Read again the tokens of an input after it was edited, changing a
+		 * TokenTable read by tokenizeAll() before the edit.
+		 * 
+		 * Only the tokens near the edit are read: the input is read from the end
+		 * of the last token that can't change, until a token starts where a token
+		 * after the edit started before it. The tokens after it are moved.
+		 * Only a MemoryInput or a MmapInput are read this way, other inputs are
+		 * read again from the start.
+		 * 
+		 * @param in The edited input, at its start. It isn't the input of this
+		 * Scanner and it will not be deleted.
+		 * @param tokens The tokens of the input before the edit, they are changed to the
+		 * tokens after it. If the input has an invalid token they are not changed.
+		 * @param editPos The position of the first character edited.
+		 * @param removedChars The number of characters removed at editPos.
+		 * @param insertedChars The number of characters inserted at editPos.
+		 * 
+		 * @return The tokens that changed.
+		 * 
+		 * @throw ParserError If the input has an invalid token.
+		 * 
+		 * @see TokenChange
+		 */
+		TokenChange retokenize(Input *in, TokenTable & tokens, unsigned int editPos,
+				unsigned int removedChars, unsigned int insertedChars) const;
+		
 		/**
 		 * @return The Input of this Scanner.
 		 */
@@ -70,9 +139,30 @@ class Scanner {
 		 */
 		const Pointer<ScannerAutomata> & getScannerAutomata() const;
 		
+		/**
+		 * Intern the text of the tokens read by nextToken() in a TokenPool.
+		 * 
+		 * The tokens read with the same pool share the strings of the pool, so
+		 * a text repeated in the input is stored only once. The pool can be
+		 * shared by several Scanners, for instance to parse many files, but it
+		 * isn't locked: the Scanners sharing a pool must be used by the same thread.
+		 * 
+		 * @param pool The TokenPool, or NULL (the default) for tokens with their own text.
+		 * 
+		 * @see TokenPool
+		 */
+		void setTokenPool(const Pointer<TokenPool> & pool);
+		
+		/**
+		 * @return The TokenPool of this Scanner, or NULL.
+		 */
+		const Pointer<TokenPool> & getTokenPool() const;
+		
 	private:
 		Pointer<ScannerAutomata> automata;
 		Input *input;
+		
+		Pointer<TokenPool> tokenPool;
 };
 
 #endif
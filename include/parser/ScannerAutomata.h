@@ -1,20 +1,32 @@
 #ifndef PARSER_SCANNER_AUTOMATA_H
 #define PARSER_SCANNER_AUTOMATA_H
 
+#include "parser/KeywordTable.h"
 #include "parser/ParserError.h"
 #include "parser/ParsingTree.h"
+#include "parser/TokenChange.h"
+#include "parser/TokenRecord.h"
 #include "parser/TokenType.h"
 
 #include <ostream>
 #include <set>
+#include <vector>
 
 class Automata;
 class Input;
+class TokenPool;
+class TokenTable;
 
 /**
  * @class ScannerAutomata
  * 
  * This class holds the Automata used by the Scanner.
+ * The token recognized in each final state is stored as the value of the
+ * state in the Automata, in the same row as the transitions of the state.
+ * 
+ * A ScannerAutomata isn't changed after it's compiled: reading tokens uses
+ * only its const methods, so a single Pointer<ScannerAutomata> can be copied
+ * to several threads, each one with its own Scanner.
  * 
  * @author Felipe Borges Alves
  * 
@@ -26,6 +38,32 @@ class ScannerAutomata {
 	public:
 		typedef std::set<TokenTypeID> TokenTypeIDSet;
 		
+		enum SkipType {
+			SKIP_NONE,
+			// the state loops while the character is one of the bytes
+			SKIP_WHILE,
+			// the state loops until the character is one of the bytes
+			SKIP_UNTIL
+		};
+		
+		// the maximum number of bytes compared to skip a state
+		static const unsigned int MAX_SKIP_BYTES = 8;
+		
+		/**
+		 * A state that loops on itself for a few bytes, like the spaces of a
+		 * whitespace token, or for all but a few bytes, like the inside of a
+		 * comment. The characters that stay in the state are skipped
+		 * comparing many of them at once with SSE2 (or AVX2) instructions,
+		 * instead of walking the table one character at a time.
+		 */
+		struct SkipState {
+			SkipType type;
+			unsigned int numBytes;
+			
+			// the bytes after numBytes repeat the first one
+			unsigned char bytes[MAX_SKIP_BYTES];
+		};
+		
 		/**
 		 * Construct a ScannerAutomata with the argument Automata.
 		 * 
@@ -56,6 +94,20 @@ class ScannerAutomata {
 		 */
 		const TokenTypeIDSet & getIgnoredTokens() const;
 		
+		/**
+		 * Register a keyword, a literal token that isn't in the automata.
+		 * When the automata recognizes <code>tokenTypeId</code> with the
+		 * characters of the keyword, <code>keywordId</code> is returned instead.
+		 * 
+		 * @see KeywordTable
+		 */
+		void addKeyword(TokenTypeID tokenTypeId, const std::string & keyword, TokenTypeID keywordId);
+		
+		/**
+		 * @return The keywords recognized after the automata.
+		 */
+		const KeywordTable & getKeywords() const;
+		
 		/**
 		 * Return the token recognized in a state.
 		 * 
@@ -74,15 +126,72 @@ class ScannerAutomata {
 		 */
 		void setStateTokenTypeId(unsigned int state, TokenTypeID tokenId);
 		
+		/**
+		 * @param state A state of the automata.
+		 * 
+		 * @return How the characters that loop in the state are skipped,
+		 * the type is SKIP_NONE if they are not.
+		 */
+		const SkipState & getSkipState(unsigned int state) const;
+		
 		/**
 		 * Read the next token.
 		 * Do not use this method directly, use Scanner::nextToken() instead.
 		 * 
 		 * @param input The Input that will supply characters to this ScannerAutomata.
+		 * @param pool The TokenPool with the text of the token, or NULL if
+		 * the token has its own text.
 		 * 
 		 * @return The next token or NULL if the end of the input was reached.
 		 */
-		ParsingTree::Token *nextToken(Input *input) const;
+		ParsingTree::Token *nextToken(Input *input, TokenPool *pool = NULL) const;
+		
+		/**
+		 * Read the next token without its characters.
+		 * Do not use this method directly, use Scanner::nextTokens() instead.
+		 * 
+		 * After reading a token the marked position of the input is the
+		 * start of the token.
+		 * 
+		 * @param input The Input that will supply characters to this ScannerAutomata.
+		 * @param record Where the token will be stored.
+		 * @param location If the line and column of the token should be stored.
+		 * 
+		 * @return False if the end of the input was reached.
+		 */
+		bool nextToken(Input *input, TokenRecord & record, bool location) const;
+		
+		/**
+		 * Read all the tokens of the input.
+		 * Do not use this method directly, use Scanner::tokenizeAll() instead.
+		 * 
+		 * With more than one thread, the input must have all its characters
+		 * in the buffer returned by Input::getBuffer(), like a MemoryInput.
+		 * 
+		 * @param input The Input that will supply characters to this ScannerAutomata.
+		 * @param tokens Where the tokens will be stored, the previous tokens are removed.
+		 * @param numThreads The maximum number of threads used.
+		 */
+		void tokenize(Input *input, TokenTable & tokens, unsigned int numThreads = 1) const;
+		
+		/**
+		 * Read again the tokens of an input after it was edited.
+		 * Do not use this method directly, use Scanner::retokenize() instead.
+		 * 
+		 * The input must have all its characters in the buffer returned by
+		 * Input::getBuffer(), like a MemoryInput.
+		 * 
+		 * @param input The edited input, at its start.
+		 * @param tokens The tokens of the input before the edit, they are changed
+		 * to the tokens after it. If an invalid token is found they are not changed.
+		 * @param editPos The position of the first character edited.
+		 * @param removedChars The number of characters removed at editPos.
+		 * @param insertedChars The number of characters inserted at editPos.
+		 * 
+		 * @return The tokens changed.
+		 */
+		TokenChange retokenize(Input *input, TokenTable & tokens, unsigned int editPos,
+				unsigned int removedChars, unsigned int insertedChars) const;
 		
 		// check if this ScannerAutomata is in a consistent state
 		void sanityCheck() const;
@@ -93,13 +202,52 @@ class ScannerAutomata {
 		
 		friend std::ostream & operator<<(std::ostream & stream, const ScannerAutomata & automata);
 		
+		// walks the automata through the chunks of an input
+		friend class ScannerSession;
+		
 	private:
-		Automata *automata;
+		// find the states that can be skipped, the transitions of the automata
+		// must not change after the ScannerAutomata is constructed
+		void findSkipStates();
+		
+		// read the next token like nextToken(Input *, TokenRecord &, bool), chars is
+		// set to the characters of the token if they are still in the buffer, else NULL,
+		// scanEnd to its TokenTable::getScanEnd()
+		bool nextRecord(Input *input, TokenRecord & record, bool location, const char *& chars,
+				unsigned int & scanEnd) const;
+		
+		// walk the characters of [current, end) in the automata
+		const char *walkAutomata(int & state, const char *current, const char *end,
+				int & reconizedToken, const char *& tokenEnd) const;
+		
+		// read the token that starts at current, return its length or 0 if
+		// there isn't a valid token, readChars is set to the characters read by
+		// the automata (end counts as a character if it was reached)
+		unsigned int scanToken(const char *current, const char *end, TokenTypeID & id,
+				unsigned int & readChars) const;
+		
+		// the error of the invalid token that starts at current, in the location
+		// (line, column) of the input called inputName
+		ParserError invalidToken(const std::string & inputName, const char *current,
+				const char *end, unsigned int line, unsigned int column) const;
 		
-		// the tokens recognized in each state
-		int *stateTokenTypeId;
+		// a part of an input tokenized by one thread
+		struct Chunk;
+		
+		// tokenize the characters of a buffer in chunks, one thread for each chunk
+		void tokenizeParallel(Input *input, const char *buffer, unsigned int size,
+				TokenTable & tokens, unsigned int numChunks) const;
+		
+		// tokenize a chunk from its start, that may be in the middle of a token
+		void tokenizeChunk(Chunk & chunk) const;
+		static void *tokenizeChunkThread(void *chunk);
+		
+		Automata *automata;
 		
 		TokenTypeIDSet ignoredTokens;
+		KeywordTable keywords;
+		
+		std::vector<SkipState> skipStates;
 };
 
 #endif
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+class Automata;
 class Grammar;
 class ScannerAutomata;
 
@@ -27,14 +28,32 @@ class ScannerGrammar {
 		typedef DynamicAutomata::State State;
 		typedef DynamicAutomata::StateList StateList;
 		typedef DynamicAutomata::StateSet StateSet;
+		typedef DynamicAutomata::StateSetList StateSetList;
 		typedef DynamicAutomata::StateSetToState StateSetToState;
 		
+		typedef std::vector<TokenTypeID> TokenIDList;
+		
+		// a literal token reconized by a generic token with lower priority
+		struct Keyword {
+			std::string literal;
+			unsigned int generic;
+		};
+		
+		// maps the index of the literal token to its keyword
+		typedef std::map<unsigned int, Keyword> KeywordList;
+		
+		// find the literal tokens that can be keywords of the ScannerAutomata
+		void findKeywords(const TokenIDList & tokenIds, KeywordList & keywords) const;
+		
+		// if the automata reconizes only one string, get it
+		static bool getLiteral(const Automata *automata, std::string & literal);
+		
 		static ScannerAutomata *convertAutomata(DynamicAutomata *dAutomata, const StateToToken & stateToken);
 		static void minimizeAutomata(DynamicAutomata *automata, StateToToken & stateToken);
-
+		
 		static DynamicAutomata *mergeAllAutomatas(const DynamicAutomataVector & dAutomataVector,
 				StateToToken & stateToken);
-
+				
 		static DynamicAutomata *mergeAutomatas(DynamicAutomata *automataA,
 				DynamicAutomata *automataB, StateToToken & stateToken);
 		
@@ -43,7 +62,7 @@ class ScannerGrammar {
 		
 		static void updateStateTokens(StateToToken & stateToken, const StateToState & oldToNew);
 		static void updateStateTokens(StateToToken & stateToken, const StateSetToState & oldToNew);
-
+		
 		static void updateStateToken(StateToToken & stateToken,
 				State *oldState, State *newState);
 		
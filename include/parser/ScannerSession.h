@@ -0,0 +1,98 @@
+#ifndef PARSER_SCANNER_SESSION_H
+#define PARSER_SCANNER_SESSION_H
+
+#include "parser/Pointer.h"
+#include "parser/ScannerAutomata.h"
+#include "parser/TokenTable.h"
+
+#include <string>
+
+/**
+ * @class ScannerSession
+ * 
+ * Read the tokens of an input that is given in chunks, like the data read
+ * from a socket.
+ * 
+ * A Scanner pulls the characters from an Input, a ScannerSession is pushed
+ * the characters by feed() as they arrive. The state of the automata is kept
+ * between the chunks, so a token can be split in any number of chunks and
+ * the chunks don't need to be joined. Only the characters of a token that
+ * isn't complete at the end of a chunk are kept by the session.
+ * 
+ * The tokens read are added to a TokenTable, that works as a queue: the
+ * tokens can be used after each call to feed() and removed with
+ * TokenTable::clear(). The ignored tokens are not added.
+ * 
+ * @author Felipe Borges Alves
+ * 
+ * @see Scanner
+ */
+class ScannerSession {
+	public:
+		/**
+		 * @param a The ScannerAutomata used to read the tokens.
+		 * @param name The name of the input, used in the locations of the tokens.
+		 */
+		ScannerSession(const Pointer<ScannerAutomata> & a, const std::string & name = "input");
+		
+		/**
+		 * Read the tokens of the next characters of the input.
+		 * The characters are not used after this method returns.
+		 * 
+		 * @param chars The characters.
+		 * @param size The number of characters.
+		 * 
+		 * @throw ParserError If the input has an invalid token.
+		 */
+		void feed(const char *chars, unsigned int size);
+		
+		/**
+		 * Read the tokens that end with the input, after its last characters
+		 * were given to feed(). The session can then read another input.
+		 * 
+		 * @throw ParserError If the input ends with an invalid token.
+		 */
+		void finish();
+		
+		/**
+		 * @return The tokens read and not removed, the table can be changed.
+		 */
+		TokenTable & getTokens();
+		
+		/**
+		 * @return The number of characters given to feed() that are part of a
+		 * token not read yet.
+		 */
+		unsigned int getPendingChars() const;
+		
+	private:
+		// walk the automata through the characters, keeping the token that
+		// isn't complete at the end of them
+		void scan(const char *current, const char *end);
+		
+		// add a complete token and start the next one, readChars is the number of
+		// characters read by the automata to find it
+		void addToken(const char *chars, unsigned int length, unsigned int readChars);
+		
+		void reset();
+		
+		Pointer<ScannerAutomata> automata;
+		TokenTable tokens;
+		
+		// the token being read: its characters already fed, the state of the
+		// automata and the last token recognized
+		std::string pending;
+		int state;
+		int reconizedToken;
+		unsigned int tokenLength;
+		
+		// the location of the start of the token being read
+		unsigned int inputPos;
+		unsigned int line;
+		unsigned int column;
+		
+		// the end of the characters read since the last token added
+		unsigned int scanEnd;
+};
+
+#endif
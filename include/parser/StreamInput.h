@@ -0,0 +1,131 @@
+#ifndef PARSER_STREAM_INPUT_H
+#define PARSER_STREAM_INPUT_H
+
+#include "parser/Input.h"
+
+#include <istream>
+
+/**
+ * @class StreamInput
+ * 
+ * Input implementation which reads from a file descriptor or an std::istream
+ * that cannot seek, like pipes, sockets and stdin.
+ * 
+ * The characters are kept in a ring buffer. Only the characters since the
+ * last marked position are kept in memory, so rollbacks must not go back
+ * further than the last call to markPosition() (the Scanner marks the start
+ * of each token). The buffer grows only when a single pending token is larger
+ * than it, so the memory used doesn't depend on the size of the stream.
+ * 
+ * The positions of the input are unsigned ints, so a stream can have at most
+ * UINT_MAX characters (4 GB), an IOError is thrown when a longer stream is read.
+ * 
+ * @author Felipe Borges Alves
+ */
+class StreamInput : public Input {
+	public:
+		/**
+		 * Construct a StreamInput that reads from a file descriptor.
+		 * The file descriptor is not closed by this class.
+		 * The default input name will be used.
+		 * 
+		 * @param fd The file descriptor used to read the input.
+		 */
+		StreamInput(int fd);
+		
+		/**
+		 * Construct a StreamInput that reads from a file descriptor.
+		 * The file descriptor is not closed by this class.
+		 * 
+		 * @param fd The file descriptor used to read the input.
+		 * @param name The name of the input.
+		 */
+		StreamInput(int fd, const std::string & name);
+		
+		/**
+		 * Construct a StreamInput that reads from an std::istream.
+		 * The stream must exist while this input is used.
+		 * The default input name will be used.
+		 * 
+		 * @param stream The stream used to read the input.
+		 */
+		StreamInput(std::istream & stream);
+		
+		/**
+		 * Construct a StreamInput that reads from an std::istream.
+		 * The stream must exist while this input is used.
+		 * 
+		 * @param stream The stream used to read the input.
+		 * @param name The name of the input.
+		 */
+		StreamInput(std::istream & stream, const std::string & name);
+		virtual ~StreamInput();
+		
+		/**
+		 * The line is read from the characters still in the buffer, if the
+		 * start of the line was discarded only its end is returned.
+		 * 
+		 * @return The current line of this input.
+		 */
+		virtual std::string getCurrentLine();
+		
+		virtual void sanityCheck() const;
+		
+		/**
+		 * Change the current position of this Input.
+		 * Positions after the end of the buffer are reached by reading and
+		 * discarding the stream.
+		 * 
+		 * @param pos The new position.
+		 * 
+		 * @throw IOError If the position was already discarded from the buffer.
+		 */
+		virtual void setInputPos(unsigned int pos);
+		
+	protected:
+		/**
+		 * Construct a StreamInput for subclasses that read the characters
+		 * by overriding readStream().
+		 * 
+		 * @param name The name of the input.
+		 */
+		StreamInput(const std::string & name);
+		
+		virtual bool fetchBuffer();
+		
+		/**
+		 * Read characters from the stream.
+		 * 
+		 * @param buf Where the characters will be stored.
+		 * @param size The maximum number of characters to read.
+		 * 
+		 * @return How many characters were read, 0 at the end of the stream.
+		 * 
+		 * @throw IOError If an error occur while reading.
+		 */
+		virtual unsigned int readStream(char *buf, unsigned int size);
+		
+	private:
+		void init();
+		
+		// read more characters to the buffer, without discarding the characters after keepPos
+		// if grow is true the buffer grows when it's full
+		bool fillBuffer(unsigned int keepPos, bool grow);
+		
+		// set the window to the characters starting at inputPos
+		void setWindow();
+		
+		int fileDescriptor;
+		std::istream *stream;
+		bool eof;
+		
+		char *buffer;
+		unsigned int bufSize;
+		
+		// the characters between startPos and endPos are in the buffer,
+		// the character at the position pos is at buffer[pos % bufSize]
+		unsigned int startPos;
+		unsigned int endPos;
+};
+
+#endif
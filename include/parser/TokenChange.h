@@ -0,0 +1,24 @@
+#ifndef PARSER_TOKEN_CHANGE_H
+#define PARSER_TOKEN_CHANGE_H
+
+/**
+ * @struct TokenChange
+ * 
+ * The tokens of a TokenTable changed by Scanner::retokenize().
+ * 
+ * The <code>removed</code> tokens starting at the index <code>first</code>
+ * of the table before the edit were replaced by the <code>added</code>
+ * tokens starting at the same index. The tokens before them didn't change,
+ * and the tokens after them are the same tokens, moved by the edit.
+ * 
+ * @author Felipe Borges Alves
+ * 
+ * @see Scanner
+ */
+struct TokenChange {
+	unsigned int first;
+	unsigned int removed;
+	unsigned int added;
+};
+
+#endif
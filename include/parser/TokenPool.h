@@ -0,0 +1,73 @@
+#ifndef PARSER_TOKEN_POOL_H
+#define PARSER_TOKEN_POOL_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @class TokenPool
+ * 
+ * A pool of token texts, each different text is stored only once.
+ * 
+ * When a Scanner has a TokenPool, the tokens it reads don't have their own
+ * copy of the characters: ParsingTree::Token::getToken() returns the string
+ * of the pool. Two tokens read with the same pool have the same text only if
+ * they have the same pooled string, so ParsingTree::Token::getPooledToken()
+ * can be compared instead of the characters.
+ * 
+ * The strings are kept until the pool is deleted, and the pool can be shared
+ * by the Scanners of several inputs. The pool must exist while its tokens are
+ * used, it's usually shared with a Pointer.
+ * 
+ * @author Felipe Borges Alves
+ * 
+ * @see Scanner::setTokenPool()
+ */
+class TokenPool {
+	public:
+		TokenPool();
+		
+		/**
+		 * Find the string of a text in the pool, adding it if needed.
+		 * 
+		 * @param chars The characters of the text.
+		 * @param length The number of characters.
+		 * 
+		 * @return The string of the text, valid while the pool exists.
+		 */
+		const std::string *intern(const char *chars, unsigned int length);
+		
+		inline const std::string *intern(const std::string & text) {
+			return intern(text.data(), text.size());
+		}
+		
+		/**
+		 * @return The number of different texts in the pool.
+		 */
+		inline unsigned int size() const {
+			return strings.size();
+		}
+		
+		// check if this TokenPool is in a consistent state
+		void sanityCheck() const;
+		
+	private:
+		static inline unsigned int hash(const char *chars, unsigned int length) {
+			unsigned int h = 2166136261u;
+			for (unsigned int i = 0; i < length; ++i) h = (h ^ (unsigned char)chars[i]) * 16777619;
+			return h;
+		}
+		
+		// double the slots, keeping the table at most half full
+		void grow();
+		
+		// a deque doesn't move its strings when it grows
+		std::deque<std::string> strings;
+		
+		// the strings in each slot or NULL, a power of 2 slots
+		std::vector<const std::string *> slots;
+		std::vector<unsigned int> hashes;
+};
+
+#endif
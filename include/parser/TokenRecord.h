@@ -0,0 +1,35 @@
+#ifndef PARSER_TOKEN_RECORD_H
+#define PARSER_TOKEN_RECORD_H
+
+#include "parser/TokenType.h"
+
+/**
+ * @struct TokenRecord
+ * 
+ * A token read by Scanner::nextTokens(), without the characters of the token.
+ * 
+ * Reading records doesn't allocate memory, the records are stored in an array
+ * owned by the caller that can be reused. The characters of the token are
+ * the <code>length</code> characters of the input starting at
+ * <code>inputPos</code>, if needed they must be kept by the caller (a
+ * MemoryInput or a MmapInput already has all of them in memory).
+ * 
+ * @author Felipe Borges Alves
+ * 
+ * @see Scanner
+ */
+struct TokenRecord {
+	TokenTypeID tokenTypeId;
+	
+	// the position of the first character of the token in the input,
+	// the same as ParsingTree::Token::getInputPos()
+	unsigned int inputPos;
+	unsigned int length;
+	
+	// the location of the first character, only set when the
+	// locations were asked to the scanner
+	unsigned int line;
+	unsigned int column;
+};
+
+#endif
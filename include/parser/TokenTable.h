@@ -0,0 +1,180 @@
+#ifndef PARSER_TOKEN_TABLE_H
+#define PARSER_TOKEN_TABLE_H
+
+#include "parser/InputLocation.h"
+#include "parser/TokenType.h"
+
+#include <cassert>
+#include <climits>
+#include <string>
+#include <vector>
+
+/**
+ * @class TokenTable
+ * 
+ * All the tokens of an input, read by Scanner::tokenizeAll().
+ * 
+ * The tokens are stored in parallel arrays (one array for the types, one for
+ * the positions and so on), and the characters of all the tokens are kept
+ * together in a single string, so reading a whole input costs only a few
+ * allocations. The ignored tokens are not stored.
+ * 
+ * The table doesn't depend on the input after it's read, so it can be kept
+ * to parse the same input again. Both ParserTableLL1 and ParserTableSLR1
+ * can parse a TokenTable, see Parser::parse(const TokenTable &).
+ * 
+ * @author Felipe Borges Alves
+ * 
+ * @see Scanner
+ */
+class TokenTable {
+	public:
+		TokenTable();
+		
+		/**
+		 * Remove all the tokens, keeping the memory allocated.
+		 */
+		void clear();
+		
+		/**
+		 * @return The number of tokens.
+		 */
+		inline unsigned int size() const {
+			return tokenTypeIds.size();
+		}
+		
+		inline TokenTypeID getTokenTypeId(unsigned int index) const {
+			assert(index < size());
+			return tokenTypeIds[index];
+		}
+		
+		/**
+		 * @return The position of the first character of the token in the input,
+		 * the same as ParsingTree::Token::getInputPos().
+		 */
+		inline unsigned int getInputPos(unsigned int index) const {
+			assert(index < size());
+			return inputPositions[index];
+		}
+		
+		inline unsigned int getLength(unsigned int index) const {
+			assert(index < size());
+			return textPositions[index + 1] - textPositions[index];
+		}
+		
+		/**
+		 * @return The characters of the token, they are not null-terminated.
+		 */
+		inline const char *getTokenChars(unsigned int index) const {
+			assert(index < size());
+			return text.data() + textPositions[index];
+		}
+		
+		std::string getToken(unsigned int index) const;
+		
+		inline unsigned int getLine(unsigned int index) const {
+			assert(index < size());
+			return lines[index];
+		}
+		
+		inline unsigned int getColumn(unsigned int index) const {
+			assert(index < size());
+			return columns[index];
+		}
+		
+		InputLocation getInputLocation(unsigned int index) const;
+		
+		/**
+		 * @return The position after the last character read by the scanner to
+		 * find the token and the ignored tokens before it, the end of the input
+		 * is counted as a character. The token is read again by
+		 * Scanner::retokenize() when an edit is before this position. UINT_MAX
+		 * if it's unknown.
+		 */
+		inline unsigned int getScanEnd(unsigned int index) const {
+			assert(index < size());
+			return scanEnds[index];
+		}
+		
+		void setScanEnd(unsigned int index, unsigned int scanEnd);
+		
+		// the arrays with the values of all tokens
+		const std::vector<TokenTypeID> & getTokenTypeIds() const;
+		const std::vector<unsigned int> & getInputPositions() const;
+		
+		/**
+		 * @return The name of the input of the tokens.
+		 */
+		const std::string & getInputName() const;
+		void setInputName(const std::string & name);
+		
+		/**
+		 * @return The location of the end of the input.
+		 */
+		const InputLocation & getEndLocation() const;
+		void setEndLocation(const InputLocation & location);
+		
+		/**
+		 * Add a token to the end of the table.
+		 * 
+		 * @param id The type of the token.
+		 * @param pos The position of the token in the input.
+		 * @param chars The characters of the token, they are copied.
+		 * @param length The number of characters of the token.
+		 * @param line The line of the token.
+		 * @param column The column of the token.
+		 * @param scanEnd The position after the characters read to find the token,
+		 * see getScanEnd().
+		 */
+		void addToken(TokenTypeID id, unsigned int pos, const char *chars, unsigned int length,
+				unsigned int line, unsigned int column, unsigned int scanEnd = UINT_MAX);
+		
+		/**
+		 * Allocate the memory for tokens that will be added.
+		 * 
+		 * @param numTokens The number of tokens.
+		 * @param numChars The number of characters of all the tokens.
+		 */
+		void reserve(unsigned int numTokens, unsigned int numChars);
+		
+		/**
+		 * Replace some tokens by all the tokens of another table.
+		 * 
+		 * @param first The index of the first token replaced.
+		 * @param count The number of tokens replaced.
+		 * @param tokens The new tokens, with their positions and locations.
+		 */
+		void replaceTokens(unsigned int first, unsigned int count, const TokenTable & tokens);
+		
+		/**
+		 * Move the tokens that are after an edit of the input, with their scan ends.
+		 * 
+		 * @param first The index of the first token moved, the tokens after it are moved too.
+		 * @param posOffset The number of characters added before the tokens, negative
+		 * if characters were removed.
+		 * @param line The line where the edit ends, before the move. The tokens in this
+		 * line are also moved by <code>columnOffset</code>.
+		 * @param lineOffset The number of lines added before the tokens.
+		 * @param columnOffset The number of columns added before the tokens of <code>line</code>.
+		 */
+		void moveTokens(unsigned int first, int posOffset, unsigned int line, int lineOffset,
+				int columnOffset);
+		
+	private:
+		std::vector<TokenTypeID> tokenTypeIds;
+		std::vector<unsigned int> inputPositions;
+		
+		// the token i is the characters of text between textPositions[i] and textPositions[i + 1]
+		std::vector<unsigned int> textPositions;
+		std::string text;
+		
+		std::vector<unsigned int> lines;
+		std::vector<unsigned int> columns;
+		
+		std::vector<unsigned int> scanEnds;
+		
+		std::string inputName;
+		InputLocation endLocation;
+};
+
+#endif
@@ -10,6 +10,7 @@
 #include <unistd.h>
 
 ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
+	directScanner = false;
 	dumpSlr1 = false;
 	format = FORMAT_CPP;
 	parserType = TYPE_SLR1;
@@ -18,8 +19,9 @@ ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 	scanner = NULL;
 	variable = "parser";
 	
-	const char *shortOptions = "df:ho:p:s:t:v:";
+	const char *shortOptions = "Ddf:ho:p:s:t:v:";
 	struct option longOptions[] = {
+		{"direct", false, NULL, 'D'},
 		{"dump", false, NULL, 'd'},
 		{"format", true, NULL, 'f'},
 		{"help", false, NULL, 'h'},
@@ -34,6 +36,9 @@ ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 	int c;
 	while ((c = getopt_long(argc, argv, shortOptions, longOptions, &longIndex)) != -1) {
 		switch (c) {
+			case 'D':
+				directScanner = true;
+				break;
 			case 'd':
 				dumpSlr1 = true;
 				break;
@@ -70,6 +75,10 @@ ArgumentOptions::ArgumentOptions(int argc, char * const argv[]) {
 	}
 }
 
+bool ArgumentOptions::getDirectScanner() const {
+	return directScanner;
+}
+
 bool ArgumentOptions::getDumpSlr1() const {
 	return dumpSlr1;
 }
@@ -128,6 +137,8 @@ void ArgumentOptions::setupParserType(const char *t) {
 void ArgumentOptions::showUsage() {
 	std::cerr << "Usage: parsergen [OPTIONS]" << std::endl;
 	
+	std::cerr << "  -D, --direct\t\t Also generate the scanner as a function in the C/C++ code," << std::endl;
+	std::cerr << "\t\t with one block of code for each state of the automata." << std::endl;
 	std::cerr << "  -d, --dump\t\t Dump SLR1 states information." << std::endl;
 	
 	std::cerr << "  -f, --format FORMAT\t Specify the output format:" << std::endl;
@@ -16,6 +16,7 @@ class ArgumentOptions {
 		
 		ArgumentOptions(int argc, char * const argv[]);
 		
+		bool getDirectScanner() const;
 		bool getDumpSlr1() const;
 		OutputFormat getFormat() const;
 		ParserType getPaserType() const;
@@ -30,6 +31,7 @@ class ArgumentOptions {
 		void setupFormat(const char *f);
 		void setupParserType(const char *t);
 		
+		bool directScanner;
 		bool dumpSlr1;
 		OutputFormat format;
 		ParserType parserType;
@@ -1,5 +1,6 @@
 #include "ArgumentOptions.h"
 
+#include "parser/Automata.h"
 #include "parser/Grammar.h"
 #include "parser/GrammarLoader.h"
 #include "parser/IOError.h"
@@ -11,6 +12,7 @@
 #include "parser/ParserTable.h"
 #include "parser/ScannerAutomata.h"
 #include "parser/ScannerGrammar.h"
+#include "parser/KeywordTable.h"
 
 #include <cctype>
 #include <cstdio>
@@ -19,6 +21,12 @@
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <vector>
+
+// the runs of characters with the same transition that are compared as a
+// range by the direct scanner, instead of a case of a switch
+#define MIN_RANGE_SIZE 4
 
 static void saveBin(Grammar *grammar, ScannerAutomata *automata,
 		ParserTable *table, const char *outputFile);
@@ -27,20 +35,21 @@ template<class T>
 static void safeWrite(FILE *fp, const T *buffer, unsigned int size);
 
 static void saveCpp(Grammar *grammar, ScannerAutomata *automata,
-		ParserTable *table, const char *outputFile, const char *variable);
+		ParserTable *table, const char *outputFile, const char *variable, bool direct);
 static void saveC(Grammar *grammar, ScannerAutomata *automata,
-		ParserTable *table, const char *outputFile, const char *variable);
+		ParserTable *table, const char *outputFile, const char *variable, bool direct);
 
 static void saveSourcesFiles(std::fstream & header, std::fstream & source, const char *outputFile,
-		Grammar *grammar, ScannerAutomata *automata, ParserTable *table, const char *variable);
+		Grammar *grammar, ScannerAutomata *automata, ParserTable *table, const char *variable,
+		bool direct);
 
 static void saveHeader(std::fstream & output, const char *outputFile,
 		Grammar *grammar, ScannerAutomata *automata, ParserTable *table,
-		const std::string & varScanner, const std::string & varParser);
+		const std::string & varScanner, const std::string & varParser, bool direct);
 
 static void saveSource(std::fstream & output, const char *outputFile,
 		ScannerAutomata *automata, ParserTable *table,
-		const std::string & varScanner, const std::string & varParser);
+		const std::string & varScanner, const std::string & varParser, bool direct);
 
 static void dumpComment(std::fstream & output);
 
@@ -49,6 +58,14 @@ static void dumpVariable(std::fstream & output, const std::string & varName,
 
 inline static void getHexaCode(unsigned char byte, char *hexa);
 
+static void dumpDirectScanner(std::fstream & output, const std::string & varName,
+		ScannerAutomata *automata);
+
+static void dumpTransitions(std::fstream & output, ScannerAutomata *automata, unsigned int state);
+
+static std::string charCode(unsigned int c);
+static std::string stringCode(const std::string & str);
+
 static void dumpEnum(std::fstream & output, const std::string & enumName,
 		const std::string & varPrefix, const std::map<std::string, unsigned int> & valueMap);
 
@@ -129,16 +146,18 @@ int main(int argc, char *argv[]) {
 	if (options.getOutputFile()) outputFile = options.getOutputFile();
 	
 	const char *variable = options.getVariable();
+	bool direct = options.getDirectScanner() && automata;
 	
 	switch (options.getFormat()) {
 		case ArgumentOptions::FORMAT_BIN:
+			if (direct) std::cerr << "Warning: the direct scanner is not saved in a binary file.\n";
 			saveBin(grammar, automata, table, outputFile);
 			break;
 		case ArgumentOptions::FORMAT_CPP:
-			saveCpp(grammar, automata, table, outputFile, variable);
+			saveCpp(grammar, automata, table, outputFile, variable, direct);
 			break;
 		case ArgumentOptions::FORMAT_C:
-			saveC(grammar, automata, table, outputFile, variable);
+			saveC(grammar, automata, table, outputFile, variable, direct);
 			break;
 		default:
 			abort();
@@ -183,29 +202,30 @@ static void safeWrite(FILE *fp, const T *buffer, unsigned int size) {
 }
 
 static void saveCpp(Grammar *grammar, ScannerAutomata *automata,
-		ParserTable *table, const char *outputFile, const char *variable) {
+		ParserTable *table, const char *outputFile, const char *variable, bool direct) {
 	
 	std::string headerFile = std::string(outputFile) + ".h";
 	std::string sourceFile = std::string(outputFile) + ".cpp";
 	
 	std::fstream header(headerFile.c_str(), std::ios::out);
 	std::fstream source(sourceFile.c_str(), std::ios::out);
-	saveSourcesFiles(header, source, outputFile, grammar, automata, table, variable);
+	saveSourcesFiles(header, source, outputFile, grammar, automata, table, variable, direct);
 }
 
 static void saveC(Grammar *grammar, ScannerAutomata *automata,
-		ParserTable *table, const char *outputFile, const char *variable) {
+		ParserTable *table, const char *outputFile, const char *variable, bool direct) {
 	
 	std::string headerFile = std::string(outputFile) + ".h";
 	std::string sourceFile = std::string(outputFile) + ".c";
 	
 	std::fstream header(headerFile.c_str(), std::ios::out);
 	std::fstream source(sourceFile.c_str(), std::ios::out);
-	saveSourcesFiles(header, source, outputFile, grammar, automata, table, variable);
+	saveSourcesFiles(header, source, outputFile, grammar, automata, table, variable, direct);
 }
 
 static void saveSourcesFiles(std::fstream & header, std::fstream & source, const char *outputFile,
-		Grammar *grammar, ScannerAutomata *automata, ParserTable *table, const char *variable) {
+		Grammar *grammar, ScannerAutomata *automata, ParserTable *table, const char *variable,
+		bool direct) {
 	
 	std::string variableScanner = std::string(variable) + "_scanner";
 	std::string variableParser = std::string(variable) + "_parser";
@@ -219,8 +239,8 @@ static void saveSourcesFiles(std::fstream & header, std::fstream & source, const
 		exit(-1);
 	}
 	
-	saveHeader(header, outputFile, grammar, automata, table, variableScanner, variableParser);
-	saveSource(source, outputFile, automata, table, variableScanner, variableParser);
+	saveHeader(header, outputFile, grammar, automata, table, variableScanner, variableParser, direct);
+	saveSource(source, outputFile, automata, table, variableScanner, variableParser, direct);
 	
 	header.close();
 	source.close();
@@ -228,7 +248,7 @@ static void saveSourcesFiles(std::fstream & header, std::fstream & source, const
 
 static void saveHeader(std::fstream & output, const char *outputFile,
 		Grammar *grammar, ScannerAutomata *automata, ParserTable *table,
-		const std::string & varScanner, const std::string & varParser) {
+		const std::string & varScanner, const std::string & varParser, bool direct) {
 	
 	std::string upperOutput = toUpperCase(outputFile);
 	
@@ -253,6 +273,15 @@ static void saveHeader(std::fstream & output, const char *outputFile,
 		output << "extern unsigned char " << varScanner << "[];\n";
 		output << "extern unsigned int " << varScanner << "_size;\n\n";
 	}
+	if (direct) {
+		output << "/* Read the token that starts at current, the characters of the input\n";
+		output << " * are [current, end). Return the token, or -1 if there is no valid token,\n";
+		output << " * and store its number of characters in length. */\n";
+		output << "int " << varScanner << "_scan(const char *current, const char *end, "
+				<< "unsigned int *length);\n\n";
+		output << "/* Return 1 if the token is ignored, otherwise 0. */\n";
+		output << "int " << varScanner << "_ignored(int token);\n\n";
+	}
 	if (table) {
 		output << "extern unsigned char " << varParser << "[];\n";
 		output << "extern unsigned int " << varParser << "_size;\n\n";
@@ -263,10 +292,11 @@ static void saveHeader(std::fstream & output, const char *outputFile,
 
 static void saveSource(std::fstream & output, const char *outputFile,
 		ScannerAutomata *automata, ParserTable *table,
-		const std::string & varScanner, const std::string & varParser) {
+		const std::string & varScanner, const std::string & varParser, bool direct) {
 	
 	dumpComment(output);
 	output << "#include \"" << outputFile << ".h\"\n\n";
+	if (direct) output << "#include <string.h>\n\n";
 	
 	if (automata) {
 		unsigned int scannerSize;
@@ -283,6 +313,11 @@ static void saveSource(std::fstream & output, const char *outputFile,
 		
 		dumpVariable(output, varParser, parserBuffer, parserSize);
 	}
+	
+	if (direct) {
+		output << "\n";
+		dumpDirectScanner(output, varScanner, automata);
+	}
 }
 
 static void dumpComment(std::fstream & output) {
@@ -354,6 +389,195 @@ inline static void getHexaCode(unsigned char byte, char *hexa) {
 	hexa[2] = '\0';
 }
 
+static void dumpDirectScanner(std::fstream & output, const std::string & varName,
+		ScannerAutomata *automata) {
+	
+	output << "int " << varName << "_scan(const char *current, const char *end, "
+			<< "unsigned int *length) {\n";
+	output << "\tconst char *start = current;\n";
+	output << "\tconst char *tokenEnd = current;\n";
+	output << "\tint token = -1;\n";
+	output << "\tunsigned char c;\n";
+	output << "\t\n";
+	
+	// the states that are the target of a transition need a label
+	Automata *a = automata->getAutomata();
+	unsigned int numStates = a->getNumStates();
+	std::vector<bool> targets(numStates, false);
+	std::vector<bool> transitions(numStates, false);
+	
+	for (unsigned int state = 0; state < numStates; ++state) {
+		for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+			int target = a->getTransition(state, (char)c);
+			if (target == -1) continue;
+			
+			targets[target] = true;
+			transitions[state] = true;
+		}
+	}
+	
+	// one block of code for each state, a transition is a goto to the target
+	for (unsigned int state = 0; state < numStates; ++state) {
+		// the code after the start state is only reached by a goto
+		if (state && !targets[state]) continue;
+		if (targets[state]) output << "state" << state << ":\n";
+		
+		// the start state can't recognize a token without characters
+		int token = automata->getStateTokenTypeId(state);
+		if (token != -1 && state) {
+			output << "\ttoken = " << token << ";\n";
+			output << "\ttokenEnd = current;\n";
+		}
+		
+		if (transitions[state]) {
+			output << "\tif (current == end) goto done;\n";
+			output << "\tc = (unsigned char)*current++;\n";
+			dumpTransitions(output, automata, state);
+		}
+		
+		output << "\tgoto done;\n";
+	}
+	
+	output << "\t\n";
+	output << "done:\n";
+	output << "\tif (token == -1) return -1;\n";
+	output << "\t*length = tokenEnd - start;\n";
+	
+	// the keywords are recognized by their generic token
+	const KeywordTable & keywords = automata->getKeywords();
+	if (keywords.size()) {
+		std::map<TokenTypeID, std::map<unsigned int, std::vector<unsigned int> > > generic;
+		for (unsigned int i = 0; i < keywords.size(); ++i)
+			generic[keywords.getTokenTypeId(i)][keywords.getKeyword(i).size()].push_back(i);
+		
+		output << "\t\n";
+		output << "\tswitch (token) {\n";
+		
+		for (std::map<TokenTypeID, std::map<unsigned int, std::vector<unsigned int> > >::const_iterator
+				it = generic.begin(); it != generic.end(); ++it) {
+			
+			output << "\t\tcase " << it->first << ":\n";
+			output << "\t\t\tswitch (*length) {\n";
+			
+			for (std::map<unsigned int, std::vector<unsigned int> >::const_iterator
+					length = it->second.begin(); length != it->second.end(); ++length) {
+				
+				output << "\t\t\t\tcase " << length->first << ":\n";
+				for (unsigned int i = 0; i < length->second.size(); ++i) {
+					unsigned int index = length->second[i];
+					output << "\t\t\t\t\tif (!memcmp(start, " << stringCode(keywords.getKeyword(index))
+							<< ", " << length->first << ")) return " << keywords.getKeywordId(index)
+							<< ";\n";
+				}
+				output << "\t\t\t\t\tbreak;\n";
+			}
+			
+			output << "\t\t\t}\n";
+			output << "\t\t\tbreak;\n";
+		}
+		
+		output << "\t}\n";
+	}
+	
+	output << "\t\n";
+	output << "\treturn token;\n";
+	output << "}\n\n";
+	
+	output << "int " << varName << "_ignored(int token) {\n";
+	
+	const ScannerAutomata::TokenTypeIDSet & ignored = automata->getIgnoredTokens();
+	if (!ignored.empty()) {
+		output << "\tswitch (token) {\n";
+		for (ScannerAutomata::TokenTypeIDSet::const_iterator it = ignored.begin();
+				it != ignored.end(); ++it) {
+			output << "\t\tcase " << *it << ":\n";
+		}
+		output << "\t\t\treturn 1;\n";
+		output << "\t}\n";
+	}
+	
+	output << "\treturn 0;\n";
+	output << "}\n";
+}
+
+static void dumpTransitions(std::fstream & output, ScannerAutomata *automata, unsigned int state) {
+	
+	Automata *a = automata->getAutomata();
+	
+	// the runs of characters with the same target state
+	std::vector<unsigned int> runStart;
+	std::vector<int> runTarget;
+	
+	for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+		int target = a->getTransition(state, (char)c);
+		if (runTarget.empty() || runTarget.back() != target) {
+			runStart.push_back(c);
+			runTarget.push_back(target);
+		}
+	}
+	runStart.push_back(ALPHABET_SIZE);
+	
+	// the long runs are compared as ranges, the other characters in a switch
+	std::map<int, std::vector<unsigned int> > cases;
+	
+	for (unsigned int i = 0; i < runTarget.size(); ++i) {
+		int target = runTarget[i];
+		if (target == -1) continue;
+		
+		unsigned int first = runStart[i];
+		unsigned int last = runStart[i + 1] - 1;
+		
+		if (last - first + 1 >= MIN_RANGE_SIZE) {
+			output << "\tif (";
+			if (first) output << "c >= " << charCode(first);
+			if (first && last + 1 < ALPHABET_SIZE) output << " && ";
+			if (last + 1 < ALPHABET_SIZE) output << "c <= " << charCode(last);
+			output << ") goto state" << target << ";\n";
+		}
+		else {
+			for (unsigned int c = first; c <= last; ++c) cases[target].push_back(c);
+		}
+	}
+	
+	if (cases.empty()) return;
+	
+	output << "\tswitch (c) {\n";
+	for (std::map<int, std::vector<unsigned int> >::const_iterator it = cases.begin();
+			it != cases.end(); ++it) {
+		
+		output << "\t\t";
+		for (unsigned int i = 0; i < it->second.size(); ++i) {
+			output << "case " << charCode(it->second[i]) << ": ";
+		}
+		output << "goto state" << it->first << ";\n";
+	}
+	output << "\t}\n";
+}
+
+static std::string charCode(unsigned int c) {
+	char code[8];
+	if (isgraph(c) && c != '\'' && c != '\\') sprintf(code, "'%c'", c);
+	else sprintf(code, "%u", c);
+	return code;
+}
+
+static std::string stringCode(const std::string & str) {
+	std::string code = "\"";
+	for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+		unsigned char c = *it;
+		if (c == '"' || c == '\\') code.push_back('\\');
+		
+		if (isprint(c)) code.push_back(c);
+		else {
+			char octal[8];
+			sprintf(octal, "\\%03o", c);
+			code += octal;
+		}
+	}
+	code.push_back('"');
+	return code;
+}
+
 static void dumpEnum(std::fstream & output, const std::string & enumName,
 		const std::string & varPrefix, const std::map<std::string, unsigned int> & valueMap) {
 	output << "enum " << enumName << " {\n";
@@ -4,56 +4,159 @@
 #include "parser/ParserDefs.h"
 
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <new>
 
 #define CHECK_STATE(s) assert((s) >= -1  && (s) < (int)numStates)
 
-Automata::Automata(unsigned int size) : numStates(size) {
+#define CACHE_LINE_SIZE 64
+
+// the smallest entry that can store value
+static unsigned int entrySizeFor(unsigned int value) {
+	if (value <= 0xFF) return 1;
+	if (value <= 0xFFFF) return 2;
+	return 4;
+}
+
+static unsigned int maxEntryValue(unsigned int entrySize) {
+	if (entrySize == 1) return 0xFF;
+	if (entrySize == 2) return 0xFFFF;
+	return 0xFFFFFFFF;
+}
+
+Automata::Automata(unsigned int size) : numStates(size), numClasses(0), table(NULL), rowSize(0) {
 	assert(size > 0);
 	
-	transitionTable = new int *[ALPHABET_SIZE];
-	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) {
-		transitionTable[i] = new int[numStates];
-		for (unsigned int j = 0; j < numStates; ++j) transitionTable[i][j] = -1;
-	}
+	// every character starts in the class 0, without transitions
+	memset(inputClasses, 0, sizeof(inputClasses));
 	
-	createStates();
+	layoutTable(std::vector<unsigned int>(1, 0), 1, entrySizeFor(numStates));
 }
 
-Automata::Automata(const int * const *transitions, unsigned int size) : numStates(size) {
+Automata::Automata(const int * const *transitions, unsigned int size) : numStates(size),
+		numClasses(0), table(NULL), rowSize(0) {
 	assert(size > 0);
 	
-	transitionTable = new int *[ALPHABET_SIZE];
+	std::vector<unsigned int> columns(ALPHABET_SIZE);
 	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) {
-		transitionTable[i] = new int[numStates];
-		for (unsigned int j = 0; j < numStates; ++j) transitionTable[i][j] = transitions[i][j];
+		inputClasses[i] = i;
+		columns[i] = i;
 	}
 	
-	createStates();
+	layoutTable(columns, ALPHABET_SIZE, entrySizeFor(numStates));
+	
+	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) {
+		for (unsigned int j = 0; j < numStates; ++j) {
+			CHECK_STATE(transitions[i][j]);
+			setEntry(j * rowSize + 1 + i, transitions[i][j] + 1);
+		}
+	}
+	
+	compressAlphabet();
+}
+
+Automata::Automata(const unsigned char *inputClasses, const void *table, unsigned int entrySize,
+		unsigned int classes, unsigned int size) : numStates(size), numClasses(0),
+		table(NULL), rowSize(0) {
+	assert(size > 0);
+	assert(classes > 0 && classes <= ALPHABET_SIZE);
+	assert(entrySize == 1 || entrySize == 2 || entrySize == 4);
+	
+	memcpy(this->inputClasses, inputClasses, sizeof(this->inputClasses));
+	
+	std::vector<unsigned int> columns(classes);
+	for (unsigned int i = 0; i < classes; ++i) columns[i] = i;
+	layoutTable(columns, classes, entrySize);
+	
+	// the rows of the argument table are not padded
+	unsigned int rowBytes = (classes + 1) * entrySize;
+	for (unsigned int i = 0; i < numStates; ++i) {
+		memcpy((unsigned char *)this->table + i * rowSize * entrySize,
+				(const unsigned char *)table + i * rowBytes, rowBytes);
+	}
 }
 
 Automata::~Automata() {
-	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) delete[](transitionTable[i]);
-	delete[](transitionTable);
-	delete[](finalStates);
+	free(table);
 }
 
-void Automata::createStates() {
-	finalStates = new bool[numStates];
-	memset(finalStates, 0, sizeof(bool) * numStates);
+void Automata::setEntry(unsigned int index, unsigned int value) {
+	assert(value <= maxEntryValue(entrySize));
+	
+	switch (entrySize) {
+		case 1:
+			((uint8_t *)table)[index] = value;
+			break;
+		case 2:
+			((uint16_t *)table)[index] = value;
+			break;
+		default:
+			((uint32_t *)table)[index] = value;
+	}
 }
 
-void Automata::setTransitionTable(const int * const *transitions) {
-	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) {
-		for (unsigned int j = 0; j < numStates; ++j) {
-			CHECK_STATE(transitions[i][j]);
-			transitionTable[i][j] = transitions[i][j];
+void Automata::layoutTable(const std::vector<unsigned int> & columns, unsigned int classCapacity,
+		unsigned int newEntrySize) {
+	assert(columns.size() <= classCapacity);
+	
+	// a row smaller than a cache line is padded to a power of two, so it
+	// never crosses two lines, bigger rows are padded to whole lines
+	unsigned int rowBytes = (classCapacity + 1) * newEntrySize;
+	if (rowBytes <= CACHE_LINE_SIZE) {
+		unsigned int size = newEntrySize;
+		while (size < rowBytes) size *= 2;
+		rowBytes = size;
+	}
+	else rowBytes = (rowBytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+	
+	void *newTable;
+	if (posix_memalign(&newTable, CACHE_LINE_SIZE, rowBytes * numStates)) throw std::bad_alloc();
+	memset(newTable, 0, rowBytes * numStates);
+	
+	void *oldTable = table;
+	unsigned int oldRowSize = rowSize;
+	unsigned int oldEntrySize = entrySize;
+	
+	table = newTable;
+	rowSize = rowBytes / newEntrySize;
+	entrySize = newEntrySize;
+	numClasses = columns.size();
+	
+	if (!oldTable) return;
+	
+	// copy the entries, changing their size if needed
+	for (unsigned int i = 0; i < numStates; ++i) {
+		unsigned int oldRow = i * oldRowSize;
+		unsigned int newRow = i * rowSize;
+		
+		setEntry(newRow, getEntry(oldTable, oldEntrySize, oldRow));
+		for (unsigned int j = 0; j < numClasses; ++j) {
+			setEntry(newRow + 1 + j, getEntry(oldTable, oldEntrySize, oldRow + 1 + columns[j]));
 		}
 	}
+	
+	free(oldTable);
+}
+
+const void *Automata::getTransitionTable() const {
+	return table;
+}
+
+unsigned int Automata::getRowSize() const {
+	return rowSize;
 }
 
-const int * const *Automata::getTransitionTable() const {
-	return transitionTable;
+unsigned int Automata::getEntrySize() const {
+	return entrySize;
+}
+
+const unsigned char *Automata::getInputClasses() const {
+	return inputClasses;
+}
+
+unsigned int Automata::getNumClasses() const {
+	return numClasses;
 }
 
 unsigned int Automata::getNumStates() const {
@@ -63,19 +166,75 @@ unsigned int Automata::getNumStates() const {
 void Automata::setTransition(unsigned int state, char input, int destinationState) {
 	assert(state < numStates);
 	CHECK_STATE(destinationState);
-	assert(input >= 0);
 	
-	transitionTable[(int)input][state] = destinationState;
+	if (getTransition(state, input) == destinationState) return;
+	
+	unsigned int inputClass = splitClass(input);
+	setEntry(state * rowSize + 1 + inputClass, destinationState + 1);
 }
 
-bool Automata::isFinalState(unsigned int state) const {
-	assert(state < numStates);
-	return finalStates[state];
+unsigned int Automata::splitClass(unsigned char input) {
+	unsigned int inputClass = inputClasses[input];
+	
+	// check if some other character is in the same class
+	unsigned int c = 0;
+	while (c < ALPHABET_SIZE && (c == input || inputClasses[c] != inputClass)) ++c;
+	if (c == ALPHABET_SIZE) return inputClass;
+	
+	// there is at most one class for each character
+	assert(numClasses < ALPHABET_SIZE);
+	
+	std::vector<unsigned int> columns(numClasses + 1);
+	for (unsigned int i = 0; i < numClasses; ++i) columns[i] = i;
+	columns[numClasses] = inputClass;
+	
+	// the new class has the same transitions of the old one
+	if (numClasses + 1 < rowSize) {
+		for (unsigned int i = 0; i < numStates; ++i) {
+			setEntry(i * rowSize + 1 + numClasses, getEntry(i * rowSize + 1 + inputClass));
+		}
+		++numClasses;
+	}
+	else {
+		unsigned int capacity = numClasses * 2 < ALPHABET_SIZE ? numClasses * 2 : ALPHABET_SIZE;
+		layoutTable(columns, capacity, entrySize);
+	}
+	
+	inputClasses[input] = numClasses - 1;
+	return numClasses - 1;
+}
+
+void Automata::compressAlphabet() {
+	// the new class of each old class, the classes are numbered by their first character
+	std::map<std::vector<unsigned int>, unsigned int> columnToClass;
+	std::vector<int> oldToNew(numClasses, -1);
+	std::vector<unsigned int> columns;
+	
+	for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+		unsigned int oldClass = inputClasses[c];
+		
+		if (oldToNew[oldClass] == -1) {
+			std::vector<unsigned int> column(numStates);
+			for (unsigned int i = 0; i < numStates; ++i) column[i] = getEntry(i * rowSize + 1 + oldClass);
+			
+			std::map<std::vector<unsigned int>, unsigned int>::const_iterator it = columnToClass.find(column);
+			if (it != columnToClass.end()) oldToNew[oldClass] = it->second;
+			else {
+				columnToClass[column] = columns.size();
+				oldToNew[oldClass] = columns.size();
+				columns.push_back(oldClass);
+			}
+		}
+		
+		inputClasses[c] = oldToNew[oldClass];
+	}
+	
+	layoutTable(columns, columns.size(), entrySize);
 }
 
 void Automata::setFinalState(unsigned int state) {
 	assert(state < numStates);
-	finalStates[state] = true;
+	if (getEntry(state * rowSize) == NOT_FINAL) setEntry(state * rowSize, FINAL_WITHOUT_VALUE);
 }
 
 void Automata::setFinalStates(const std::vector<unsigned int> & stateList) {
@@ -84,26 +243,50 @@ void Automata::setFinalStates(const std::vector<unsigned int> & stateList) {
 	}
 }
 
+int Automata::getFinalStateValue(unsigned int state) const {
+	assert(state < numStates);
+	
+	unsigned int value = getEntry(state * rowSize);
+	return value >= FINAL_VALUE ? (int)(value - FINAL_VALUE) : -1;
+}
+
+void Automata::setFinalStateValue(unsigned int state, unsigned int value) {
+	assert(state < numStates);
+	
+	if (value + FINAL_VALUE > maxEntryValue(entrySize)) {
+		std::vector<unsigned int> columns(numClasses);
+		for (unsigned int i = 0; i < numClasses; ++i) columns[i] = i;
+		layoutTable(columns, rowSize - 1, entrySizeFor(value + FINAL_VALUE));
+	}
+	
+	setEntry(state * rowSize, value + FINAL_VALUE);
+}
+
 bool Automata::accept(const char *input) const {
 	int state = 0;
 	
 	while (*input && state != -1) {
-		state = transitionTable[(unsigned int)*(input++)][state];
+		state = getTransition(state, *(input++));
 	}
 	
 	if (state == -1) return false;
-	return finalStates[state];
+	return isFinalState(state);
 }
 
 void Automata::sanityCheck() const {
-	assert(transitionTable);
-	assert(finalStates);
+	assert(table);
+	assert((size_t)table % CACHE_LINE_SIZE == 0);
+	
+	assert(numClasses > 0 && numClasses <= ALPHABET_SIZE);
+	assert(numClasses < rowSize);
 	
 	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) {
-		assert(transitionTable[i]);
-		
-		for (unsigned int j = 0; j < numStates; ++j) {
-			CHECK_STATE(transitionTable[i][j]);
+		assert(inputClasses[i] < numClasses);
+	}
+	
+	for (unsigned int i = 0; i < numStates; ++i) {
+		for (unsigned int j = 0; j < numClasses; ++j) {
+			CHECK_STATE((int)getEntry(i * rowSize + 1 + j) - 1);
 		}
 	}
 }
@@ -158,7 +341,7 @@ std::ostream & operator<<(std::ostream & stream, const Automata & automata) {
 	// put a * on the columns of final states
 	stream << "\t\t";
 	for (unsigned int j = 0; j < automata.numStates; ++j) {
-		if (automata.finalStates[j]) stream << "*";
+		if (automata.isFinalState(j)) stream << "*";
 		if (j < automata.numStates - 1) stream << "\t";
 	}
 	stream << "\n";
@@ -190,8 +373,8 @@ std::ostream & operator<<(std::ostream & stream, const Automata & automata) {
 		else stream << i << "\t\t";
 		
 		for (unsigned int j = 0; j < automata.numStates; ++j) {
-			if (j > 0) stream << "\t" << automata.transitionTable[i][j];
-			else stream << automata.transitionTable[i][j];
+			if (j > 0) stream << "\t" << automata.getTransition(j, i);
+			else stream << automata.getTransition(j, i);
 			
 		}
 		stream << "\n";
@@ -2,6 +2,7 @@
 
 #include "parser/Automata.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <queue>
@@ -10,168 +11,324 @@
 /*****************************************************************************
  * DynamicAutomata::EquivalenceClasses
  *****************************************************************************/
+// Hopcroft's partition refinement, over the indices of the states. The
+// automata is completed with a dead state, the target of all the missing
+// transitions, and the characters with the same transitions in every state
+// are used as a single input.
 class DynamicAutomata::EquivalenceClasses {
 	public:
-		EquivalenceClasses(DynamicAutomata *a, bool finalMerge);
+		EquivalenceClasses(const DynamicAutomata *a, const StateSetList & finalClasses);
 		
-		const StateSetList & getEquivalenceClasses() const;
+		/**
+		 * @return The class of the state with the index, or -1 if no final
+		 * state can be reached from it. The classes are numbered by their first state.
+		 */
+		int getClass(unsigned int state) const;
+		
+		unsigned int getNumClasses() const;
 		
 	private:
-		bool splitEquivalenceClasses();
-		bool fillEquivalenceClasses(StateSet & newClass, StateSet::iterator stateAIt);
-		bool isEquivalent(State *stateA, State *stateB) const;
+		void createInverseTransitions(const DynamicAutomata *a);
+		void createBlock(unsigned int begin, unsigned int end);
+		void splitBlocks(const std::vector<unsigned int> & splitter);
+		void mark(unsigned int state);
+		void numberClasses();
 		
-		void printEquivalences(std::ostream & stream, const StateSetList & eqv) const;
+		// the states of the automata and the dead state
+		unsigned int numStates;
+		unsigned int numInputs;
 		
-		DynamicAutomata *automata;
+		// the sources of the transitions with the input i to the state t are
+		// sources[inverseStart[i * numStates + t]] to sources[inverseStart[i * numStates + t + 1] - 1]
+		std::vector<unsigned int> inverseStart;
+		std::vector<unsigned int> sources;
 		
-		StateSetList equivalences;
-		StateSetList newEquivalences;
+		// the states of the block b are elements[blockBegin[b]] to elements[blockEnd[b] - 1],
+		// the marked ones first, up to blockMarked[b]
+		std::vector<unsigned int> elements;
+		std::vector<unsigned int> location;
+		std::vector<unsigned int> stateBlock;
+		std::vector<unsigned int> blockBegin;
+		std::vector<unsigned int> blockEnd;
+		std::vector<unsigned int> blockMarked;
 		
-		StateSetList::iterator currentClass;
+		std::vector<unsigned int> touchedBlocks;
+		std::vector<unsigned int> splitters;
 		
-		StateSet markedStates;
+		std::vector<int> classes;
+		unsigned int numClasses;
 };
 
-const DynamicAutomata::StateSetList & DynamicAutomata::EquivalenceClasses::getEquivalenceClasses() const {
-	return equivalences;
-}
-
-DynamicAutomata::EquivalenceClasses::EquivalenceClasses(DynamicAutomata *a,
-		bool finalMerge) : automata(a) {
+DynamicAutomata::EquivalenceClasses::EquivalenceClasses(const DynamicAutomata *a,
+		const StateSetList & finalClasses) : numStates(a->getNumStates() + 1) {
 	
-	StateSet finalStates;
-	automata->getFinalStates(finalStates);
+	createInverseTransitions(a);
+	
+	StateIndex stateIndex;
+	a->getStateIndex(stateIndex);
 	
-	StateSet nonFinalStates;
-	automata->getNonFinalStates(nonFinalStates);
-	nonFinalStates.insert(NULL);
+	// the initial blocks: the classes of final states and the other states
+	elements.reserve(numStates);
+	location.resize(numStates);
+	stateBlock.resize(numStates);
 	
-	if (finalMerge) equivalences.push_back(finalStates);
-	else {
-		// do not merge final states
-		// put each final state in an equivalence class
-		for (StateSet::const_iterator it = finalStates.begin(); it != finalStates.end(); ++it) {
-			StateSet equvClass;
-			equvClass.insert(*it);
-			equivalences.push_back(equvClass);
+	std::vector<bool> placed(numStates, false);
+	for (StateSetList::const_iterator it = finalClasses.begin(); it != finalClasses.end(); ++it) {
+		if (it->empty()) continue;
+		
+		unsigned int begin = elements.size();
+		for (StateSet::const_iterator it2 = it->begin(); it2 != it->end(); ++it2) {
+			assert((*it2)->isFinalState());
+			
+			unsigned int state = stateIndex[*it2];
+			assert(!placed[state]);
+			placed[state] = true;
+			elements.push_back(state);
 		}
+		createBlock(begin, elements.size());
+	}
+	
+	unsigned int begin = elements.size();
+	for (unsigned int i = 0; i < numStates; ++i) {
+		if (placed[i]) continue;
+		
+		assert(i == numStates - 1 || !a->getState(i)->isFinalState());
+		elements.push_back(i);
 	}
+	createBlock(begin, elements.size());
 	
-	equivalences.push_back(nonFinalStates);
+	// every block splits the others
+	for (unsigned int b = 0; b < blockBegin.size(); ++b) splitters.push_back(b);
 	
-	bool changed = true;
-	while (changed) {
-		newEquivalences.clear();
-		changed = splitEquivalenceClasses();
-		equivalences = newEquivalences;
+	std::vector<unsigned int> splitter;
+	while (!splitters.empty()) {
+		unsigned int block = splitters.back();
+		splitters.pop_back();
+		
+		// the block may be split while it's used
+		splitter.assign(elements.begin() + blockBegin[block], elements.begin() + blockEnd[block]);
+		splitBlocks(splitter);
 	}
+	
+	numberClasses();
 }
 
-bool DynamicAutomata::EquivalenceClasses::splitEquivalenceClasses() {
-	bool changed = false;
+void DynamicAutomata::EquivalenceClasses::createInverseTransitions(const DynamicAutomata *a) {
+	unsigned int deadState = numStates - 1;
 	
-	for (StateSetList::iterator it = equivalences.begin(); it != equivalences.end(); ++it) {
-		currentClass = it;
-		markedStates.clear();
-		
-		for (StateSet::iterator it2 = it->begin(); it2 != it->end(); ++it2) {
-			if (markedStates.find(*it2) == markedStates.end()) {
-				markedStates.insert(*it2);
-				
-				StateSet newClass;
-				newClass.insert(*it2);
-				
-				changed |= fillEquivalenceClasses(newClass, it2);
-				
-				newEquivalences.push_back(newClass);
-			}
+	StateIndex stateIndex;
+	a->getStateIndex(stateIndex);
+	
+	// the target of each transition, by character
+	std::vector<unsigned int> targets(ALPHABET_SIZE * numStates, deadState);
+	for (unsigned int i = 0; i < deadState; ++i) {
+		State *state = a->getState(i);
+		for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+			State *target = state->getTransition(c);
+			if (target) targets[c * numStates + i] = stateIndex[target];
 		}
+	}
+	
+	// the characters with the same column are the same input
+	std::map<std::vector<unsigned int>, unsigned int> columnInput;
+	std::vector<unsigned int> inputChars;
+	for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+		std::vector<unsigned int> column(targets.begin() + c * numStates,
+				targets.begin() + (c + 1) * numStates);
 		
-		if (markedStates.find(*it->begin()) == markedStates.end()) {
-			StateSet newClass;
-			newClass.insert(*it->begin());
-			newEquivalences.push_back(newClass);
+		if (columnInput.insert(std::make_pair(column, inputChars.size())).second) {
+			inputChars.push_back(c);
 		}
 	}
+	numInputs = inputChars.size();
+	
+	// count the transitions to each state, then place their sources
+	inverseStart.assign(numInputs * numStates + 1, 0);
+	for (unsigned int i = 0; i < numInputs; ++i) {
+		const unsigned int *column = &targets[inputChars[i] * numStates];
+		for (unsigned int j = 0; j < numStates; ++j) ++inverseStart[i * numStates + column[j] + 1];
+	}
+	
+	for (unsigned int i = 1; i < inverseStart.size(); ++i) inverseStart[i] += inverseStart[i - 1];
 	
-	return changed;
+	sources.resize(numInputs * numStates);
+	std::vector<unsigned int> next(inverseStart.begin(), inverseStart.end() - 1);
+	for (unsigned int i = 0; i < numInputs; ++i) {
+		const unsigned int *column = &targets[inputChars[i] * numStates];
+		for (unsigned int j = 0; j < numStates; ++j) sources[next[i * numStates + column[j]]++] = j;
+	}
 }
 
-bool DynamicAutomata::EquivalenceClasses::fillEquivalenceClasses(StateSet & newClass,
-		StateSet::iterator stateAIt) {
-	bool changed = false;
+void DynamicAutomata::EquivalenceClasses::createBlock(unsigned int begin, unsigned int end) {
+	if (begin == end) return;
 	
-	StateSet::iterator stateBIt = stateAIt;
-	for (++stateBIt; stateBIt != currentClass->end(); ++stateBIt) {
-		if (markedStates.find(*stateBIt) == markedStates.end()) {
-			if (isEquivalent(*stateAIt, *stateBIt)) {
-				newClass.insert(*stateBIt);
-				markedStates.insert(*stateBIt);
-			}
-			else changed = true;
-		}
-	}
+	unsigned int block = blockBegin.size();
+	blockBegin.push_back(begin);
+	blockEnd.push_back(end);
+	blockMarked.push_back(begin);
 	
-	return changed;
+	for (unsigned int i = begin; i < end; ++i) {
+		location[elements[i]] = i;
+		stateBlock[elements[i]] = block;
+	}
 }
 
-bool DynamicAutomata::EquivalenceClasses::isEquivalent(State *stateA, State *stateB) const {
-	// check if both are PHI
-	if (!stateA && !stateB) return true;
-	
-	// check if one of them are PHI
-	if (!stateA) {
-		// if stateB has any transition to a live state, it is not equivalent
-		for (unsigned int input = 0; input < ALPHABET_SIZE; ++input) {
-			const StateSet *stateList = stateB->getTransitions(input);
-			if (stateList) {
-				assert(!stateList->empty());
-				for (StateSetList::const_iterator it = equivalences.begin();
-						it != equivalences.end(); ++it) {
-					
-					if ((it->find(*stateList->begin()) != it->end()) ^ (it->find(NULL) != it->end())) {
-						return false;
-					}
-				}
+void DynamicAutomata::EquivalenceClasses::splitBlocks(const std::vector<unsigned int> & splitter) {
+	for (unsigned int input = 0; input < numInputs; ++input) {
+		// mark the states with a transition to the splitter
+		for (std::vector<unsigned int>::const_iterator it = splitter.begin(); it != splitter.end(); ++it) {
+			unsigned int target = input * numStates + *it;
+			for (unsigned int i = inverseStart[target]; i < inverseStart[target + 1]; ++i) {
+				mark(sources[i]);
 			}
 		}
 		
-		return true;
-	}
-	if (!stateB) return isEquivalent(stateB, stateA);
-	
-	for (unsigned int input = 0; input < ALPHABET_SIZE; ++input) {
-		State *tsa = stateA->getTransition(input);
-		State *tsb = stateB->getTransition(input);
-		
-		for (StateSetList::const_iterator it = equivalences.begin();
-				it != equivalences.end(); ++it) {
+		// split the blocks with marked and unmarked states, the smaller part
+		// is a new block that splits the others
+		for (std::vector<unsigned int>::const_iterator it = touchedBlocks.begin();
+				it != touchedBlocks.end(); ++it) {
+			
+			unsigned int block = *it;
+			unsigned int begin = blockBegin[block];
+			unsigned int marked = blockMarked[block];
+			unsigned int end = blockEnd[block];
+			blockMarked[block] = begin;
+			
+			if (marked == end) continue;
 			
-			if ((it->find(tsa) != it->end()) ^ (it->find(tsb) != it->end())) {
-				return false;
+			if (marked - begin <= end - marked) {
+				blockBegin[block] = marked;
+				blockMarked[block] = marked;
+				createBlock(begin, marked);
 			}
+			else {
+				blockEnd[block] = marked;
+				createBlock(marked, end);
+			}
+			
+			splitters.push_back(blockBegin.size() - 1);
 		}
+		touchedBlocks.clear();
 	}
+}
+
+void DynamicAutomata::EquivalenceClasses::mark(unsigned int state) {
+	unsigned int block = stateBlock[state];
+	unsigned int marked = blockMarked[block];
+	if (location[state] < marked) return;
 	
-	return true;
+	if (marked == blockBegin[block]) touchedBlocks.push_back(block);
+	
+	// swap the state with the first unmarked state
+	unsigned int other = elements[marked];
+	elements[location[state]] = other;
+	location[other] = location[state];
+	elements[marked] = state;
+	location[state] = marked;
+	
+	++blockMarked[block];
 }
 
-void DynamicAutomata::EquivalenceClasses::printEquivalences(std::ostream & stream,
-		const StateSetList & eqv) const {
+void DynamicAutomata::EquivalenceClasses::numberClasses() {
+	unsigned int deadBlock = stateBlock[numStates - 1];
 	
-	StateIndex stateIndex;
-	automata->getStateIndex(stateIndex);
-	for (StateSetList::const_iterator it = eqv.begin(); it != eqv.end(); ++it) {
-		stream << "{";
-		for (StateSet::iterator it2 = it->begin(); it2 != it->end(); ++it2) {
-			if (it2 != it->begin()) stream << ", ";
-			if (*it2) stream << stateIndex[*it2];
-			else stream << "PHY";
+	std::vector<int> blockClass(blockBegin.size(), -1);
+	classes.resize(numStates - 1);
+	numClasses = 0;
+	
+	for (unsigned int i = 0; i < numStates - 1; ++i) {
+		unsigned int block = stateBlock[i];
+		if (block != deadBlock && blockClass[block] == -1) blockClass[block] = numClasses++;
+		classes[i] = blockClass[block];
+	}
+}
+
+int DynamicAutomata::EquivalenceClasses::getClass(unsigned int state) const {
+	assert(state < classes.size());
+	return classes[state];
+}
+
+unsigned int DynamicAutomata::EquivalenceClasses::getNumClasses() const {
+	return numClasses;
+}
+
+/*****************************************************************************
+ * StateSetTable
+ *****************************************************************************/
+// the sets of states created by DynamicAutomata::determinize(), each set is
+// a sorted list of state indices, found by its hash with open addressing
+class StateSetTable {
+	public:
+		StateSetTable();
+		
+		// return the index of the set, added is true if it wasn't in the table
+		unsigned int insert(const std::vector<unsigned int> & set, bool & added);
+		
+		const std::vector<unsigned int> & getSet(unsigned int index) const;
+		
+	private:
+		static unsigned int hash(const std::vector<unsigned int> & set);
+		
+		void grow();
+		
+		std::vector<std::vector<unsigned int> > sets;
+		std::vector<unsigned int> hashes;
+		
+		// the index of the set + 1, or 0 for an empty slot
+		std::vector<unsigned int> slots;
+};
+
+StateSetTable::StateSetTable() : slots(64, 0) {}
+
+unsigned int StateSetTable::insert(const std::vector<unsigned int> & set, bool & added) {
+	unsigned int h = hash(set);
+	unsigned int mask = slots.size() - 1;
+	
+	unsigned int slot = h & mask;
+	while (slots[slot]) {
+		unsigned int index = slots[slot] - 1;
+		if (hashes[index] == h && sets[index] == set) {
+			added = false;
+			return index;
 		}
-		stream << "} ";
+		slot = (slot + 1) & mask;
+	}
+	
+	added = true;
+	sets.push_back(set);
+	hashes.push_back(h);
+	slots[slot] = sets.size();
+	
+	// keep the table at most half full
+	if (sets.size() * 2 > slots.size()) grow();
+	
+	return sets.size() - 1;
+}
+
+const std::vector<unsigned int> & StateSetTable::getSet(unsigned int index) const {
+	assert(index < sets.size());
+	return sets[index];
+}
+
+unsigned int StateSetTable::hash(const std::vector<unsigned int> & set) {
+	// FNV-1a over the indices
+	unsigned int h = 2166136261u;
+	for (std::vector<unsigned int>::const_iterator it = set.begin(); it != set.end(); ++it) {
+		h = (h ^ *it) * 16777619u;
+	}
+	
+	return h ^ (h >> 16);
+}
+
+void StateSetTable::grow() {
+	slots.assign(slots.size() * 2, 0);
+	unsigned int mask = slots.size() - 1;
+	
+	for (unsigned int i = 0; i < sets.size(); ++i) {
+		unsigned int slot = hashes[i] & mask;
+		while (slots[slot]) slot = (slot + 1) & mask;
+		slots[slot] = i + 1;
 	}
-	stream << "\n";
 }
 
 /*****************************************************************************
@@ -186,14 +343,11 @@ DynamicAutomata::State::~State() {
 }
 
 const DynamicAutomata::StateSet *DynamicAutomata::State::getTransitions(char input) const {
-	assert(input >= 0);
-	return transitions[(int)input];
+	return transitions[(unsigned char)input];
 }
 
 DynamicAutomata::State *DynamicAutomata::State::getTransition(char input) const {
-	assert(input >= 0);
-	
-	StateSet *stateList = transitions[(int)input];
+	StateSet *stateList = transitions[(unsigned char)input];
 	if (stateList) {
 		assert(!stateList->empty());
 		return *stateList->begin();
@@ -203,18 +357,14 @@ DynamicAutomata::State *DynamicAutomata::State::getTransition(char input) const
 }
 
 void DynamicAutomata::State::addTransition(char input, State *destState) {
-	assert(input >= 0);
-	
-	StateSet *stateList = transitions[(int)input];
-	if (!stateList) stateList = transitions[(int)input] = new StateSet();
+	StateSet *stateList = transitions[(unsigned char)input];
+	if (!stateList) stateList = transitions[(unsigned char)input] = new StateSet();
 	
 	stateList->insert(destState);
 }
 
 void DynamicAutomata::State::removeTransition(char input, State *destState) {
-	assert(input >= 0);
-	
-	StateSet *stateList = transitions[(int)input];
+	StateSet *stateList = transitions[(unsigned char)input];
 	if (!stateList) return;
 	
 	StateSet::iterator it = stateList->find(destState);
@@ -222,16 +372,16 @@ void DynamicAutomata::State::removeTransition(char input, State *destState) {
 		stateList->erase(it);
 		if (stateList->empty()) {
 			delete(stateList);
-			transitions[(int)input] = NULL;
+			transitions[(unsigned char)input] = NULL;
 		}
 	}
 }
 
 void DynamicAutomata::State::setTransition(char input, State *destState) {
-	StateSet *stateList = transitions[(int)input];
+	StateSet *stateList = transitions[(unsigned char)input];
 	
 	if (stateList) stateList->clear();
-	else stateList = transitions[(int)input] = new StateSet();
+	else stateList = transitions[(unsigned char)input] = new StateSet();
 	
 	stateList->insert(destState);
 }
@@ -439,82 +589,134 @@ void DynamicAutomata::determinize() {
 }
 
 void DynamicAutomata::determinize(StateSetToState & stateMap, StateList & oldStates) {
-	StateSet oldFinalStates;
-	getFinalStates(oldFinalStates);
+	unsigned int numStates = states.size();
 	
-	std::set<StateSet> marked;
+	StateIndex stateIndex;
+	getStateIndex(stateIndex);
 	
-	std::queue<StateSet> defineQueue;
-	StateSet initialSet;
-	initialSet.insert(initialState);
-	marked.insert(initialSet);
-	defineQueue.push(initialSet);
+	// the targets of the transitions of each state by character, as an index
+	// in targetSets, the set 0 is empty
+	std::vector<unsigned int> targetSetIds(ALPHABET_SIZE * numStates, 0);
+	std::vector<std::vector<unsigned int> > targetSets(1);
+	std::map<std::vector<unsigned int>, unsigned int> targetSetIndex;
 	
-	while (!defineQueue.empty()) {
-		StateSet stateSet = defineQueue.front();
-		defineQueue.pop();
+	std::vector<unsigned int> target;
+	for (unsigned int i = 0; i < numStates; ++i) {
+		assert(states[i]->getEpsilonTransitions()->empty());
+		
+		const StateSet *lastTransitions = NULL;
+		unsigned int lastId = 0;
 		
-		State *state;
-		StateSetToState::iterator stateIt = stateMap.find(stateSet);
-		if (stateIt != stateMap.end()) state = stateIt->second;
-		else {
-			state = new State();
-			stateMap[stateSet] = state;
+		for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+			const StateSet *transitions = states[i]->getTransitions(c);
+			if (!transitions) continue;
+			
+			// the consecutive characters usually have the same targets
+			if (!lastTransitions || *transitions != *lastTransitions) {
+				target.clear();
+				for (StateSet::const_iterator it = transitions->begin(); it != transitions->end(); ++it) {
+					target.push_back(stateIndex[*it]);
+				}
+				std::sort(target.begin(), target.end());
+				
+				std::pair<std::map<std::vector<unsigned int>, unsigned int>::iterator, bool> inserted =
+						targetSetIndex.insert(std::make_pair(target, targetSets.size()));
+				if (inserted.second) targetSets.push_back(target);
+				
+				lastTransitions = transitions;
+				lastId = inserted.first->second;
+			}
+			
+			targetSetIds[c * numStates + i] = lastId;
 		}
+	}
+	
+	// the characters with the same targets in every state are the same input
+	std::map<std::vector<unsigned int>, unsigned int> columnInput;
+	std::vector<std::vector<unsigned int> > inputChars;
+	for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+		std::vector<unsigned int> column(targetSetIds.begin() + c * numStates,
+				targetSetIds.begin() + (c + 1) * numStates);
+		
+		std::pair<std::map<std::vector<unsigned int>, unsigned int>::iterator, bool> inserted =
+				columnInput.insert(std::make_pair(column, inputChars.size()));
+		if (inserted.second) inputChars.push_back(std::vector<unsigned int>());
+		inputChars[inserted.first->second].push_back(c);
+	}
+	
+	// each new state is a sorted set of old states, found by its hash
+	StateSetTable newStateSets;
+	StateList newStates;
+	
+	bool added;
+	newStateSets.insert(std::vector<unsigned int>(1, stateIndex[initialState]), added);
+	newStates.push_back(new State());
+	
+	// the old states already in the target of an input have the current mark
+	std::vector<unsigned int> marks(numStates, 0);
+	unsigned int mark = 0;
+	
+	std::vector<unsigned int> stateSet;
+	for (unsigned int i = 0; i < newStates.size(); ++i) {
+		// the table may move the sets when it grows
+		stateSet = newStateSets.getSet(i);
+		State *state = newStates[i];
 		
-		for (StateSet::iterator it = stateSet.begin(); it != stateSet.end(); ++it) {
-			if ((*it)->isFinalState()) {
+		for (std::vector<unsigned int>::const_iterator it = stateSet.begin(); it != stateSet.end(); ++it) {
+			if (states[*it]->isFinalState()) {
 				state->setFinalState(true);
 				break;
 			}
 		}
 		
-		for (unsigned int input = 0; input < ALPHABET_SIZE; ++input) {
-			StateSet target;
+		for (unsigned int input = 0; input < inputChars.size(); ++input) {
+			const unsigned int *inputTargets = &targetSetIds[inputChars[input][0] * numStates];
 			
-			for (StateSet::iterator it = stateSet.begin(); it != stateSet.end(); ++it) {
-				const StateSet *transitions = (*it)->getTransitions(input);
-				if (transitions) {
-					for (StateSet::iterator it2 = transitions->begin(); it2 != transitions->end(); ++it2) {
-						target.insert(*it2);
+			target.clear();
+			++mark;
+			
+			for (std::vector<unsigned int>::const_iterator it = stateSet.begin(); it != stateSet.end(); ++it) {
+				const std::vector<unsigned int> & targets = targetSets[inputTargets[*it]];
+				for (std::vector<unsigned int>::const_iterator it2 = targets.begin(); it2 != targets.end(); ++it2) {
+					if (marks[*it2] != mark) {
+						marks[*it2] = mark;
+						target.push_back(*it2);
 					}
 				}
 			}
 			
-			if (!target.empty()) {
-				State *targetState;
-				
-				std::map<StateSet, State *>::iterator targetIt = stateMap.find(target);
-				if (targetIt != stateMap.end()) targetState = targetIt->second;
-				else {
-					targetState = new State();
-					stateMap[target] = targetState;
-				}
-				
-				state->addTransition(input, targetState);
-				
-				if (marked.find(target) == marked.end()) {
-					marked.insert(target);
-					defineQueue.push(target);
-				}
+			if (target.empty()) continue;
+			std::sort(target.begin(), target.end());
+			
+			unsigned int targetIndex = newStateSets.insert(target, added);
+			if (added) newStates.push_back(new State());
+			
+			const std::vector<unsigned int> & chars = inputChars[input];
+			for (std::vector<unsigned int>::const_iterator it = chars.begin(); it != chars.end(); ++it) {
+				state->addTransition(*it, newStates[targetIndex]);
 			}
 		}
 	}
 	
+	// map the sets of old states to the new states
+	for (unsigned int i = 0; i < newStates.size(); ++i) {
+		const std::vector<unsigned int> & oldSet = newStateSets.getSet(i);
+		
+		StateSet key;
+		for (std::vector<unsigned int>::const_iterator it = oldSet.begin(); it != oldSet.end(); ++it) {
+			key.insert(key.end(), states[*it]);
+		}
+		stateMap[key] = newStates[i];
+	}
+	
 	// put the states in the old state list
 	for (StateList::iterator it = states.begin(); it != states.end(); ++it) {
 		oldStates.push_back(*it);
 	}
-	states.clear();
-	
-	initialState = stateMap[initialSet];
-	// make sure the initial state is the first
-	states.push_back(initialState);
 	
-	// add the new states
-	for (std::map<StateSet, State *>::iterator it = stateMap.begin(); it != stateMap.end(); ++it) {
-		if (it->second != initialState) states.push_back(it->second);
-	}
+	// the initial state is the first
+	states = newStates;
+	initialState = states[0];
 }
 
 void DynamicAutomata::minimize() {
@@ -534,7 +736,7 @@ void DynamicAutomata::minimize(StateToState & oldStateToNewState, StateList & ol
 void DynamicAutomata::minimizeNoFinalMerge() {
 	StateToState oldStateToNewState;
 	StateList oldStates;
-	minimize(oldStateToNewState, oldStates);
+	minimizeNoFinalMerge(oldStateToNewState, oldStates);
 	
 	for (StateList::iterator it = oldStates.begin(); it != oldStates.end(); ++it) {
 		delete(*it);
@@ -549,6 +751,26 @@ void DynamicAutomata::minimizeNoFinalMerge(StateToState & oldStateToNewState,
 void DynamicAutomata::minimize(StateToState & oldStateToNewState, StateList & oldStates,
 		bool finalMerge) {
 	
+	StateSet finalStates;
+	getFinalStates(finalStates);
+	
+	StateSetList finalClasses;
+	if (finalMerge) finalClasses.push_back(finalStates);
+	else {
+		// do not merge final states
+		// put each final state in an equivalence class
+		for (StateSet::const_iterator it = finalStates.begin(); it != finalStates.end(); ++it) {
+			finalClasses.push_back(StateSet());
+			finalClasses.back().insert(*it);
+		}
+	}
+	
+	minimize(oldStateToNewState, oldStates, finalClasses);
+}
+
+void DynamicAutomata::minimize(StateToState & oldStateToNewState, StateList & oldStates,
+		const StateSetList & finalClasses) {
+	
 	StateSet oldFinalStates;
 	getFinalStates(oldFinalStates);
 	
@@ -561,43 +783,27 @@ void DynamicAutomata::minimize(StateToState & oldStateToNewState, StateList & ol
 		return;
 	}
 	
-	EquivalenceClasses equivalenceClasses(this, finalMerge);
-	const StateSetList & equivalences =  equivalenceClasses.getEquivalenceClasses();
-	
-	// map the new state to it's class
-	StateToSet newStateToClass;
+	EquivalenceClasses equivalenceClasses(this, finalClasses);
 	
-	// states that have been reused, they won't be deleted
-	StateSet reusedStates;
-	
-	initialState = NULL;
-	
-	for (StateSetList::const_iterator it = equivalences.begin(); it != equivalences.end(); ++it) {
-		assert(!it->empty());
+	// the first state of each class is reused, the states that can't reach
+	// a final state are removed
+	StateList newStates(equivalenceClasses.getNumClasses(), NULL);
+	for (unsigned int i = 0; i < states.size(); ++i) {
+		int equivalenceClass = equivalenceClasses.getClass(i);
 		
 		State *state = NULL;
-		
-		if (it->find(NULL) == it->end()) {
-			// reuse the state
-			state = *it->begin();
-			reusedStates.insert(state);
-			newStateToClass[state] = *it;
+		if (equivalenceClass != -1) {
+			if (!newStates[equivalenceClass]) newStates[equivalenceClass] = states[i];
+			state = newStates[equivalenceClass];
 		}
 		
-		for (StateSet::const_iterator it2 = it->begin(); it2 != it->end(); ++it2) {
-			if (*it2) {
-				if (*it2 == oldInitialState) {
-					assert(state); // initialState cannot die
-					initialState = state;
-				}
-				oldStateToNewState[*it2] = state;
-			}
-		}
+		if (state != states[i]) oldStates.push_back(states[i]);
+		oldStateToNewState[states[i]] = state;
 	}
 	
-	for (StateToSet::iterator it = newStateToClass.begin(); it != newStateToClass.end(); ++it) {
+	for (StateList::iterator it = newStates.begin(); it != newStates.end(); ++it) {
 		// update the state transitions
-		State *newState = it->first;
+		State *newState = *it;
 		
 		for (unsigned int input = 0; input < ALPHABET_SIZE; ++input) {
 			State *state = newState->getTransition(input);
@@ -609,21 +815,11 @@ void DynamicAutomata::minimize(StateToState & oldStateToNewState, StateList & ol
 		}
 	}
 	
-	// put the removed states in the oldStates list
-	for (StateList::iterator it = states.begin(); it != states.end(); ++it) {
-		if (reusedStates.find(*it) == reusedStates.end()) oldStates.push_back(*it);
-	}
-	states.clear();
-	
-	// make sure the initialState is the first
-	states.push_back(initialState);
-	
-	// add the new states
-	for (StateToSet::iterator it = newStateToClass.begin(); it != newStateToClass.end(); ++it) {
-		if (it->first != initialState) states.push_back(it->first);
-	}
+	// the initial state is the first state, so it's the first of its class
+	states = newStates;
+	initialState = states[0];
 	
-	assert(initialState);
+	assert(initialState == oldInitialState);
 }
 
 void DynamicAutomata::makeEmptyAutomata() {
@@ -682,6 +878,7 @@ Automata *DynamicAutomata::toAutomata() const {
 		}
 	}
 	
+	automata->compressAlphabet();
 	return automata;
 }
 
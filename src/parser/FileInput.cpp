@@ -4,39 +4,52 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
 
+#include <fcntl.h>
+
 #define BUFFER_SIZE 8192
 
+// how many characters already read are kept in the buffer when it is refilled,
+// rollbacks and getCurrentLine() inside this history don't need to read the file again
+#define HISTORY_SIZE (BUFFER_SIZE / 2)
+
 // when testing some times it's useful to reduce the size of the buffer
 //#define BUFFER_SIZE 64
 
-FileInput::FileInput(const std::string & file) : Input(file) {
+FileInput::FileInput(const std::string & file) : Input(file), bufCapacity(BUFFER_SIZE),
+		readAheadBlock(0), readAheadDepth(0), adviseEnd(0) {
+	
 	filePointer = fopen(file.c_str(), "r");
 	if (!filePointer) throw IOError(std::string("Cannot read file ") + file);
 	
 	// NOTE: must create the buffer after opening the file
 	// or an if the fine is not found we would need to delete the buffer
-	buffer = new char[BUFFER_SIZE];
+	buffer = new char[bufCapacity];
 	
-	setInputPos(0);
+	loadBuffer(0);
 }
 
-FileInput::FileInput(const char *file) : Input(file) {
+FileInput::FileInput(const char *file) : Input(file), bufCapacity(BUFFER_SIZE),
+		readAheadBlock(0), readAheadDepth(0), adviseEnd(0) {
+	
 	filePointer = fopen(file, "r");
 	if (!filePointer) throw IOError(std::string("Cannot read file ") + file);
 	
 	// NOTE: must create the buffer after opening the file
 	// or an if the fine is not found we would need to delete the buffer
-	buffer = new char[BUFFER_SIZE];
+	buffer = new char[bufCapacity];
 	
-	setInputPos(0);
+	loadBuffer(0);
 }
 
-FileInput::FileInput(FILE *fp) : filePointer(fp) {
-	buffer = new char[BUFFER_SIZE];
+FileInput::FileInput(FILE *fp) : filePointer(fp), bufCapacity(BUFFER_SIZE),
+		readAheadBlock(0), readAheadDepth(0), adviseEnd(0) {
 	
-	setInputPos(0);
+	buffer = new char[bufCapacity];
+	
+	loadBuffer(0);
 }
 
 FileInput::~FileInput() {
@@ -44,32 +57,112 @@ FileInput::~FileInput() {
 	delete[](buffer);
 }
 
-char FileInput::readChar() {
-	// assert that there are no '\0' in the middle of the buffer
-	assert(bufPos == bufSize || (bufPos < bufSize && buffer[bufPos]));
+bool FileInput::fetchBuffer() {
+	// the file pointer is always just after the end of the buffer
+	unsigned int endPos = bufferPos + bufSize;
+	assert(inputPos == endPos);
 	
-	if (bufPos >= bufSize) {
-		setInputPos(inputPos);
-		if (bufSize == 0) return '\0';
-	}
+	// keep the characters since the marked position, they are probably
+	// going to be read again after a rollback
+	// if there is room, also keep the current line
+	unsigned int keepPos = markedPos;
+	unsigned int lineStart = getLineStart();
+	if (lineStart < keepPos && endPos - lineStart <= HISTORY_SIZE) keepPos = lineStart;
+	if (keepPos < bufferPos) keepPos = bufferPos;
+	if (endPos - keepPos > HISTORY_SIZE) keepPos = endPos - HISTORY_SIZE;
+	
+	unsigned int keep = endPos - keepPos;
+	memmove(buffer, buffer + (keepPos - bufferPos), keep);
+	
+	unsigned int read = fread(buffer + keep, sizeof(char), bufCapacity - keep, filePointer);
+	
+	bufferPos = keepPos;
+	bufSize = keep + read;
+	bufferCurrent = buffer + keep;
+	bufferEnd = buffer + bufSize;
+	
+	adviseReadAhead();
+	
+	return read > 0;
+}
+
+void FileInput::setReadAhead(unsigned int blockSize, unsigned int queueDepth) {
+	assert(blockSize > 0);
+	
+	readAheadBlock = blockSize;
+	readAheadDepth = queueDepth;
+	adviseEnd = 0;
+	
+	// the lines read are counted before the buffer is replaced
+	seekLines(inputPos);
 	
-	assert(bufPos < bufSize);
+	// the history is kept in the buffer with a whole block
+	delete[](buffer);
+	bufCapacity = blockSize + HISTORY_SIZE;
+	buffer = new char[bufCapacity];
+	
+#ifdef POSIX_FADV_SEQUENTIAL
+	int fd = fileno(filePointer);
+	if (fd >= 0 && queueDepth > 0) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+	
+	loadBuffer(inputPos);
+}
+
+void FileInput::adviseReadAhead() {
+#ifdef POSIX_FADV_WILLNEED
+	if (!readAheadDepth) return;
+	
+	int fd = fileno(filePointer);
+	if (fd < 0) return;
+	
+	// the file pointer is just after the end of the buffer
+	unsigned int filePos = bufferPos + bufSize;
+	unsigned int end = filePos + readAheadBlock * readAheadDepth;
+	if (adviseEnd < filePos) adviseEnd = filePos;
+	
+	// ask for whole blocks, the kernel reads them while the current block is used
+	if (end <= adviseEnd || end - adviseEnd < readAheadBlock) return;
 	
-	++inputPos;
-	return buffer[bufPos++];
+	posix_fadvise(fd, adviseEnd, end - adviseEnd, POSIX_FADV_WILLNEED);
+	adviseEnd = end;
+#endif
 }
 
 void FileInput::setInputPos(unsigned int pos) {
+	seekLines(pos);
+	
+	if (pos >= bufferPos && pos <= bufferPos + bufSize) {
+		// the position is inside the buffer
+		inputPos = pos;
+		bufferCurrent = buffer + (pos - bufferPos);
+		bufferEnd = buffer + bufSize;
+	}
+	else loadBuffer(pos);
+}
+
+void FileInput::loadBuffer(unsigned int pos) {
 	inputPos = pos;
 	fseek(filePointer, inputPos, SEEK_SET);
-	bufSize = fread(buffer, sizeof(char), BUFFER_SIZE, filePointer);
-	bufPos = 0;
+	
+	bufferPos = inputPos;
+	bufSize = fread(buffer, sizeof(char), bufCapacity, filePointer);
+	bufferCurrent = buffer;
+	bufferEnd = buffer + bufSize;
+	
+	// after a seek backwards the blocks advised before may be gone, they're
+	// advised again from the new position
+	unsigned int filePos = bufferPos + bufSize;
+	if (filePos < adviseEnd) adviseEnd = filePos;
+	
+	adviseReadAhead();
 }
 
 void FileInput::sanityCheck() const {
 	Input::sanityCheck();
 	
-	unsigned int realPos = bufPos + ftell(filePointer) - bufSize;
+	unsigned int realPos = (bufferCurrent - buffer) + ftell(filePointer) - bufSize;
 	
 	if (realPos != inputPos) abort();
+	if (bufferPos + (bufferCurrent - buffer) != inputPos) abort();
 }
@@ -4,15 +4,21 @@
 #include "parser/GrammarLoaderProceduralLoader.h"
 #include "parser/ParserDefs.h"
 
+#include <pthread.h>
+
+static pthread_once_t grammarLoaderLoaderOnce = PTHREAD_ONCE_INIT;
+
 GrammarLoaderLoader *GrammarLoaderLoader::getGrammarLoaderLoader() {
-	if (!grammarLoaderLoader) {
+	pthread_once(&grammarLoaderLoaderOnce, createGrammarLoaderLoader);
+	return grammarLoaderLoader;
+}
+
+void GrammarLoaderLoader::createGrammarLoaderLoader() {
 #ifdef USE_PROCEDURAL_GRAMMAR
-		grammarLoaderLoader = new GrammarLoaderProceduralLoader();
+	grammarLoaderLoader = new GrammarLoaderProceduralLoader();
 #else
-		grammarLoaderLoader = new GrammarLoaderBufferLoader();
+	grammarLoaderLoader = new GrammarLoaderBufferLoader();
 #endif
-	}
-	return grammarLoaderLoader;
 }
 
 GrammarLoaderLoader::GrammarLoaderLoader() {
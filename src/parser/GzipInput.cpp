@@ -0,0 +1,47 @@
+#include "parser/GzipInput.h"
+
+#include "parser/IOError.h"
+
+#include <unistd.h>
+
+// the size of the zlib buffers, the decompressed characters go to the StreamInput buffer
+#define GZIP_BUFFER_SIZE 65536
+
+GzipInput::GzipInput(const std::string & file) : StreamInput(file) {
+	this->file = gzopen(file.c_str(), "rb");
+	if (!this->file) throw IOError(std::string("Cannot read file ") + file);
+	
+	gzbuffer(this->file, GZIP_BUFFER_SIZE);
+}
+
+GzipInput::GzipInput(const char *file) : StreamInput(file) {
+	this->file = gzopen(file, "rb");
+	if (!this->file) throw IOError(std::string("Cannot read file ") + file);
+	
+	gzbuffer(this->file, GZIP_BUFFER_SIZE);
+}
+
+GzipInput::GzipInput(int fd) : StreamInput("input") {
+	file = gzdopen(fd, "rb");
+	if (!file) {
+		close(fd);
+		throw IOError("Cannot read the file descriptor");
+	}
+	
+	gzbuffer(file, GZIP_BUFFER_SIZE);
+}
+
+GzipInput::~GzipInput() {
+	gzclose(file);
+}
+
+unsigned int GzipInput::readStream(char *buf, unsigned int size) {
+	int read = gzread(file, buf, size);
+	
+	if (read < 0) {
+		int error;
+		throw IOError(std::string("Cannot decompress ") + inputName + ": " + gzerror(file, &error));
+	}
+	
+	return read;
+}
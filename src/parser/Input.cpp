@@ -1,10 +1,24 @@
 #include "parser/Input.h"
 
-Input::Input(const std::string & name) : inputName(name), inputPos(0), inputLine(1),
-		lastLinePos(0), markedPos(0), markedLine(1), markedLastLinePos(0) {}
+#include <algorithm>
+#include <climits>
+#include <cstring>
 
-Input::Input() : inputName("input"), inputPos(0), inputLine(1), lastLinePos(0),
-		markedPos(0), markedLine(1), markedLastLinePos(0) {}
+Input::Input(const std::string & name) : inputName(name), inputPos(0), markedPos(0),
+		bufferCurrent(NULL), bufferEnd(NULL), borrowedPos(NULL), discardedLines(0),
+		indexedPos(0), lastLine(0) {
+	
+	// the first line starts at the start of the input
+	lineStarts.push_back(0);
+}
+
+Input::Input() : inputName("input"), inputPos(0), markedPos(0),
+		bufferCurrent(NULL), bufferEnd(NULL), borrowedPos(NULL), discardedLines(0),
+		indexedPos(0), lastLine(0) {
+	
+	// the first line starts at the start of the input
+	lineStarts.push_back(0);
+}
 
 Input::~Input() {}
 
@@ -14,30 +28,18 @@ InputLocation Input::getCurrentLocation() const {
 
 void Input::resetInput() {
 	setInputPos(0);
-	inputLine = 1;
-	lastLinePos = 0;
-	
 	markedPos = 0;
-	markedLine = 1;
-	markedLastLinePos = 0;
 }
 
 void Input::markPosition() {
 	markedPos = inputPos;
-	markedLine = inputLine;
-	markedLastLinePos = lastLinePos;
 }
 
 void Input::rollback(unsigned int usedChars) {
 	assert(markedPos + usedChars <= inputPos);
 	
-	setInputPos(markedPos);
-	inputLine = markedLine;
-	lastLinePos = markedLastLinePos;
-	
-	// now we need to advance usedChar chars in the input
-	// can't just sum to inputPos becouse inputLine wouldn't be updated
-	for (unsigned int i = 0; i < usedChars; ++i) nextChar();
+	// the lines are in the index, no need to read the characters again
+	setInputPos(markedPos + usedChars);
 }
 
 const std::string & Input::getInputName() const {
@@ -49,7 +51,8 @@ void Input::setInputName(const std::string & name) {
 }
 
 unsigned int Input::getInputLine() const {
-	return inputLine;
+	indexLines();
+	return discardedLines + findLine(inputPos) + 1;
 }
 
 unsigned int Input::getInputPos() const {
@@ -59,13 +62,9 @@ unsigned int Input::getInputPos() const {
 std::string Input::getCurrentLine() {
 	// save mark
 	unsigned int mPos = markedPos;
-	unsigned int mLine = markedLine;
-	unsigned int mLastLine = markedLastLinePos;
 	unsigned int iPos = inputPos;
-	unsigned int iLine = inputLine;
-	unsigned int iLastLine = lastLinePos;
 	
-	setInputPos(lastLinePos);
+	setInputPos(getLineStart());
 	
 	std::string line;
 	
@@ -77,28 +76,113 @@ std::string Input::getCurrentLine() {
 	
 	// restore mark
 	markedPos = mPos;
-	markedLine = mLine;
-	markedLastLinePos = mLastLine;
-	
 	setInputPos(iPos);
-	inputLine = iLine;
-	lastLinePos = iLastLine;
 	
 	return line;
 }
 
 unsigned int Input::getCurrentLinePos() const {
-	if (inputPos < lastLinePos) return 0;
-	return inputPos - lastLinePos;
+	return inputPos - getLineStart();
 }
 
 void Input::dumpInput(std::ostream & stream) {
-	char c;
-	while ((c = nextChar())) stream.put(c);
+	const char *buf;
+	unsigned int size;
+	
+	while ((size = getBuffer(buf))) {
+		stream.write(buf, size);
+		consumeBuffer(size);
+	}
 }
 
 void Input::sanityCheck() const {
 	assert(markedPos <= inputPos);
-	assert(markedLine <= inputLine);
-	assert(markedLastLinePos <= lastLinePos);
+	assert(bufferCurrent <= bufferEnd);
+	assert(!lineStarts.empty());
+	assert(getLineStart() <= inputPos);
+}
+
+void Input::resetBuffer() {
+	bufferCurrent = NULL;
+	bufferEnd = NULL;
+	borrowedPos = NULL;
+}
+
+bool Input::borrowBuffer(Input *in) {
+	returnBuffer(in);
+	
+	const char *buf;
+	unsigned int size = in->getBuffer(buf);
+	
+	if (!size) {
+		resetBuffer();
+		return false;
+	}
+	
+	bufferCurrent = buf;
+	bufferEnd = buf + size;
+	borrowedPos = buf;
+	
+	// the lines of a borrowed window are counted by the input it belongs to
+	indexedPos = UINT_MAX;
+	
+	return true;
+}
+
+void Input::returnBuffer(Input *in) const {
+	if (!borrowedPos) return;
+	
+	in->consumeBuffer(bufferCurrent - borrowedPos);
+	borrowedPos = bufferCurrent;
+}
+
+unsigned int Input::getLineStart() const {
+	indexLines();
+	return lineStarts[findLine(inputPos)];
+}
+
+void Input::discardLines(unsigned int pos) {
+	// keep the start of the line that contains pos
+	while (lineStarts.size() > 1 && lineStarts[1] <= pos) {
+		lineStarts.pop_front();
+		++discardedLines;
+	}
+	
+	lastLine = 0;
+}
+
+void Input::seekLines(unsigned int pos) {
+	indexLines();
+	if (pos > indexedPos) indexedPos = pos;
+}
+
+bool Input::nextBuffer() {
+	indexLines();
+	return fetchBuffer();
+}
+
+void Input::indexLines() const {
+	if (inputPos <= indexedPos) return;
+	
+	const char *current = bufferCurrent - (inputPos - indexedPos);
+	const char *newLine;
+	while ((newLine = (const char *)memchr(current, '\n', bufferCurrent - current))) {
+		current = newLine + 1;
+		lineStarts.push_back(inputPos - (bufferCurrent - current));
+	}
+	
+	indexedPos = inputPos;
+}
+
+unsigned int Input::findLine(unsigned int pos) const {
+	unsigned int size = lineStarts.size();
+	
+	// try the line of the last query and the next one before searching
+	if (lastLine < size && lineStarts[lastLine] <= pos) {
+		if (lastLine + 1 == size || pos < lineStarts[lastLine + 1]) return lastLine;
+		if (lastLine + 2 == size || pos < lineStarts[lastLine + 2]) return ++lastLine;
+	}
+	
+	lastLine = std::upper_bound(lineStarts.begin(), lineStarts.end(), pos) - lineStarts.begin() - 1;
+	return lastLine;
 }
@@ -0,0 +1,101 @@
+#include "parser/KeywordTable.h"
+
+#include <cassert>
+#include <cstdlib>
+
+// how many seeds are tried before the table grows
+#define MAX_SEEDS 64
+
+KeywordTable::KeywordTable() : slots(1, -1), mask(0), seed(0), minLength(1), maxLength(0) {}
+
+void KeywordTable::addKeyword(TokenTypeID tokenTypeId, const std::string & keyword,
+		TokenTypeID keywordId) {
+		
+	assert(!keyword.empty());
+	
+	Keyword k;
+	k.tokenTypeId = tokenTypeId;
+	k.keyword = keyword;
+	k.keywordId = keywordId;
+	keywords.push_back(k);
+	
+	if (keywords.size() == 1 || keyword.size() < minLength) minLength = keyword.size();
+	if (keyword.size() > maxLength) maxLength = keyword.size();
+	
+	if (generic.size() <= tokenTypeId) generic.resize(tokenTypeId + 1, false);
+	generic[tokenTypeId] = true;
+	
+	buildHash();
+}
+
+TokenTypeID KeywordTable::getTokenTypeId(unsigned int index) const {
+	assert(index < size());
+	return keywords[index].tokenTypeId;
+}
+
+const std::string & KeywordTable::getKeyword(unsigned int index) const {
+	assert(index < size());
+	return keywords[index].keyword;
+}
+
+TokenTypeID KeywordTable::getKeywordId(unsigned int index) const {
+	assert(index < size());
+	return keywords[index].keywordId;
+}
+
+void KeywordTable::buildHash() {
+	// start with a table at most half full
+	unsigned int numSlots = 1;
+	while (numSlots < keywords.size() * 2) numSlots *= 2;
+	
+	while (true) {
+		for (unsigned int s = 1; s <= MAX_SEEDS; ++s) {
+			slots.assign(numSlots, -1);
+			mask = numSlots - 1;
+			seed = s * 2654435761u;
+			
+			bool collision = false;
+			for (unsigned int i = 0; i < keywords.size() && !collision; ++i) {
+				const std::string & keyword = keywords[i].keyword;
+				int & slot = slots[hash(seed, keyword.data(), keyword.size()) & mask];
+				
+				if (slot != -1) collision = true;
+				else slot = i;
+			}
+			
+			if (!collision) return;
+		}
+		
+		numSlots *= 2;
+	}
+}
+
+void KeywordTable::sanityCheck() const {
+	if (slots.size() != mask + 1) abort();
+	
+	for (unsigned int i = 0; i < keywords.size(); ++i) {
+		const Keyword & keyword = keywords[i];
+		const char *chars = keyword.keyword.data();
+		
+		if (classify(keyword.tokenTypeId, chars, keyword.keyword.size()) != keyword.keywordId) abort();
+	}
+}
+
+bool KeywordTable::operator==(const KeywordTable & table) const {
+	if (size() != table.size()) return false;
+	
+	for (unsigned int i = 0; i < keywords.size(); ++i) {
+		const Keyword & keyword = keywords[i];
+		const char *chars = keyword.keyword.data();
+		
+		if (table.classify(keyword.tokenTypeId, chars, keyword.keyword.size()) != keyword.keywordId) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool KeywordTable::operator!=(const KeywordTable & table) const {
+	return !(*this == table);
+}
@@ -11,6 +11,7 @@ ListInput::~ListInput() {
 }
 
 void ListInput::resetInput() {
+	MultInput::resetInput();
 	for (int i = current; i >= 0; --i) inputList[i]->resetInput();
 	current = 0;
 }
@@ -33,17 +33,21 @@ MemoryInput::~MemoryInput() {
 
 void MemoryInput::setInputPos(unsigned int pos) {
 	assert(pos <= bufSize);
+	seekLines(pos);
+	
 	inputPos = pos;
+	bufferCurrent = buffer + inputPos;
+	bufferEnd = buffer + bufSize;
 }
 
-char MemoryInput::readChar() {
+bool MemoryInput::fetchBuffer() {
 	assert(inputPos <= bufSize);
 	
-	// assert that there are no '\0' in the middle of the buffer
-	assert(inputPos == bufSize || (inputPos < bufSize && buffer[inputPos]));
+	// the whole buffer is always available
+	bufferCurrent = buffer + inputPos;
+	bufferEnd = buffer + bufSize;
 	
-	if (inputPos < bufSize) return buffer[inputPos++];
-	return '\0';
+	return bufferCurrent < bufferEnd;
 }
 
 void MemoryInput::sanityCheck() const {
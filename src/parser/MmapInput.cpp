@@ -0,0 +1,108 @@
+#include "parser/MmapInput.h"
+
+#include "parser/IOError.h"
+
+#include <cassert>
+#include <climits>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MmapInput::MmapInput(const std::string & file) : Input(file) {
+	mapFile(file.c_str());
+}
+
+MmapInput::MmapInput(const char *file) : Input(file) {
+	mapFile(file);
+}
+
+MmapInput::~MmapInput() {
+	if (data) munmap((void *)data, dataSize);
+}
+
+void MmapInput::mapFile(const char *file) {
+	data = NULL;
+	dataSize = 0;
+	
+	int fd = open(file, O_RDONLY);
+	if (fd < 0) throw IOError(std::string("Cannot read file ") + file);
+	
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		throw IOError(std::string("Cannot read file ") + file);
+	}
+	
+	// the input positions are unsigned ints
+	if ((unsigned long long)st.st_size > UINT_MAX) {
+		close(fd);
+		throw IOError(std::string("File too large ") + file);
+	}
+	
+	dataSize = st.st_size;
+	
+	// an empty file cannot be mapped
+	if (dataSize > 0) {
+		void *mapping = mmap(NULL, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			close(fd);
+			throw IOError(std::string("Cannot map file ") + file);
+		}
+		
+		// the scanner reads the file from the start to the end
+		madvise(mapping, dataSize, MADV_SEQUENTIAL);
+		
+		data = (const char *)mapping;
+	}
+	
+	// the mapping is kept after closing the file
+	close(fd);
+	
+	setInputPos(0);
+}
+
+const char *MmapInput::getData() const {
+	return data;
+}
+
+unsigned int MmapInput::getDataSize() const {
+	return dataSize;
+}
+
+std::string MmapInput::getCurrentLine() {
+	unsigned int lineStart = getLineStart();
+	assert(lineStart <= dataSize);
+	if (!data) return std::string();
+	
+	const char *line = data + lineStart;
+	const char *end = (const char *)memchr(line, '\n', dataSize - lineStart);
+	if (!end) end = data + dataSize;
+	
+	return std::string(line, end - line);
+}
+
+void MmapInput::setInputPos(unsigned int pos) {
+	assert(pos <= dataSize);
+	seekLines(pos);
+	
+	inputPos = pos;
+	bufferCurrent = data + inputPos;
+	bufferEnd = data + dataSize;
+}
+
+bool MmapInput::fetchBuffer() {
+	// the whole file is always available
+	bufferCurrent = data + inputPos;
+	bufferEnd = data + dataSize;
+	
+	return bufferCurrent < bufferEnd;
+}
+
+void MmapInput::sanityCheck() const {
+	Input::sanityCheck();
+	assert(inputPos <= dataSize);
+	assert(bufferCurrent == data + inputPos);
+}
@@ -1,72 +1,201 @@
 #include "parser/MultInput.h"
 
 #include <cassert>
+#include <cstring>
 
-MultInput::MultInput() : inputOffset(0) {}
+MultInput::MultInput() : inputOffset(0), stitchPos(0) {}
 
 MultInput::~MultInput() {}
 
+void MultInput::resetInput() {
+	resetBuffer();
+	
+	inputPos = 0;
+	markedPos = 0;
+	inputOffset = 0;
+	
+	stitch.clear();
+	stitchPos = 0;
+	stitchParts.clear();
+}
+
 InputLocation MultInput::getCurrentLocation() const {
+	if (inStitch()) return getStitchLocation(inputPos);
+	
+	returnBuffer(currentInput());
 	return currentInput()->getCurrentLocation();
 }
 
 const std::string & MultInput::getInputName() const {
+	if (inStitch()) return findStitchPart(inputPos)->location.getName();
+	
+	returnBuffer(currentInput());
 	return currentInput()->getInputName();
 }
 
 unsigned int MultInput::getInputLine() const {
+	if (inStitch()) return getStitchLocation(inputPos).getLine();
+	
+	returnBuffer(currentInput());
 	return currentInput()->getInputLine();
 }
 
 unsigned int MultInput::getInputPos() const {
+	if (inStitch()) {
+		StitchParts::const_iterator part = findStitchPart(inputPos);
+		return part->localPos + (inputPos - part->pos);
+	}
+	
+	returnBuffer(currentInput());
 	return currentInput()->getInputPos();
 }
 
 std::string MultInput::getCurrentLine() {
+	if (inStitch()) {
+		// only the characters in the stitch are known
+		StitchParts::const_iterator part = findStitchPart(inputPos);
+		unsigned int partEnd = part + 1 != stitchParts.end() ? (part + 1)->pos : inputOffset;
+		
+		const char *begin = stitch.data() + (part->pos - stitchPos);
+		const char *current = stitch.data() + (inputPos - stitchPos);
+		const char *end = stitch.data() + (partEnd - stitchPos);
+		
+		const char *lineStart = current;
+		while (lineStart > begin && lineStart[-1] != '\n') --lineStart;
+		
+		const char *lineEnd = (const char *)memchr(current, '\n', end - current);
+		if (!lineEnd) lineEnd = end;
+		
+		return std::string(lineStart, lineEnd - lineStart);
+	}
+	
+	returnBuffer(currentInput());
+	resetBuffer();
 	return currentInput()->getCurrentLine();
 }
 
 unsigned int MultInput::getCurrentLinePos() const {
+	if (inStitch()) return getStitchLocation(inputPos).getColumn();
+	
+	returnBuffer(currentInput());
 	return currentInput()->getCurrentLinePos();
 }
 
 void MultInput::markPosition() {
+	returnBuffer(currentInput());
 	Input::markPosition();
 	currentInput()->markPosition();
 }
 
-void MultInput::rollback(unsigned int usedChars) {
-	Input *current = currentInput();
+void MultInput::setInputPos(unsigned int pos) {
+	// can't set the position before the characters kept from the previous inputs
+	assert(pos >= stitchPos);
+	
+	returnBuffer(currentInput());
+	resetBuffer();
+	
+	inputPos = pos;
+	
+	if (pos >= inputOffset) currentInput()->setInputPos(pos - inputOffset);
+	else {
+		// read the stitch, the current input continues after it
+		currentInput()->setInputPos(0);
+		
+		bufferCurrent = stitch.data() + (pos - stitchPos);
+		bufferEnd = stitch.data() + stitch.size();
+	}
+}
+
+bool MultInput::fetchBuffer() {
+	while (!borrowBuffer(currentInput())) {
+		Input *previous = currentInput();
+		unsigned int previousOffset = inputOffset;
+		
+		if (!inputFinished()) return false;
+		stitchInput(previous, previousOffset);
+	}
 	
-	// WARNING: rollback between inputs won't work!
-	assert(inputPos - markedPos <= current->getInputPos());
+	return true;
+}
+
+void MultInput::stitchInput(Input *previous, unsigned int previousOffset) {
+	assert(inputPos == inputOffset);
 	
-	if (markedPos < inputOffset) {
-		// the markedPos was in another input
-		// calculate the used characters from this input
-		if (usedChars >= inputOffset - markedPos) usedChars -= inputOffset - markedPos;
-		else usedChars = 0;
+	if (markedPos >= inputPos) {
+		// nothing from the previous input will be read again
+		stitch.clear();
+		stitchParts.clear();
+		stitchPos = inputPos;
+		return;
+	}
+	
+	if (markedPos >= previousOffset) {
+		stitch.clear();
+		stitchParts.clear();
+		stitchPos = markedPos;
+	}
+	else if (markedPos > stitchPos) {
+		// discard the characters of the stitch before the mark
+		InputLocation location = getStitchLocation(markedPos);
+		StitchParts::iterator part = stitchParts.begin()
+				+ (findStitchPart(markedPos) - stitchParts.begin());
 		
-		inputPos = inputOffset;
+		part->localPos += markedPos - part->pos;
+		part->pos = markedPos;
+		part->location = location;
+		stitchParts.erase(stitchParts.begin(), part);
+		
+		stitch.erase(0, markedPos - stitchPos);
+		stitchPos = markedPos;
+	}
+	
+	// copy the characters of the previous input after the mark
+	unsigned int localPos = markedPos > previousOffset ? markedPos - previousOffset : 0;
+	previous->setInputPos(localPos);
+	
+	StitchPart part;
+	part.pos = previousOffset + localPos;
+	part.localPos = localPos;
+	part.location = previous->getCurrentLocation();
+	stitchParts.push_back(part);
+	
+	const char *buf;
+	unsigned int size;
+	while ((size = previous->getBuffer(buf))) {
+		stitch.append(buf, size);
+		previous->consumeBuffer(size);
 	}
 	
-	current->rollback(usedChars);
+	assert(stitchPos + stitch.size() == inputOffset);
 }
 
-void MultInput::setInputPos(unsigned int pos) {
-	// can't set the position before the current file
-	assert(pos >= inputOffset);
+MultInput::StitchParts::const_iterator MultInput::findStitchPart(unsigned int pos) const {
+	assert(!stitchParts.empty());
+	assert(pos >= stitchPos && pos < inputOffset);
 	
-	currentInput()->setInputPos(pos - inputOffset);
-	inputPos = pos;
+	// there is one part for each input in the stitch, usually one or two
+	StitchParts::const_iterator it = stitchParts.begin();
+	while (it + 1 != stitchParts.end() && (it + 1)->pos <= pos) ++it;
+	
+	return it;
 }
 
-char MultInput::readChar() {
-	char c;
+InputLocation MultInput::getStitchLocation(unsigned int pos) const {
+	StitchParts::const_iterator part = findStitchPart(pos);
+	
+	unsigned int line = part->location.getLine();
+	unsigned int column = part->location.getColumn();
+	
+	const char *current = stitch.data() + (part->pos - stitchPos);
+	const char *end = stitch.data() + (pos - stitchPos);
 	
-	while ((c = currentInput()->nextChar()) == '\0') {
-		if (!inputFinished()) break;
+	const char *newLine;
+	while ((newLine = (const char *)memchr(current, '\n', end - current))) {
+		++line;
+		column = 0;
+		current = newLine + 1;
 	}
+	column += end - current;
 	
-	return c;
+	return InputLocation(part->location.getName(), line, column);
 }
@@ -21,46 +21,59 @@ void OffsetInput::setRenameInput(bool rename) {
 }
 
 void OffsetInput::resetInput() {
+	resetBuffer();
 	input->resetInput();
 }
 
 InputLocation OffsetInput::getCurrentLocation() const {
+	returnBuffer(input);
 	InputLocation loc = input->getCurrentLocation();
 	return InputLocation(getInputName(), loc.getLine() + offset, loc.getColumn());
 }
 
 const std::string & OffsetInput::getInputName() const {
+	returnBuffer(input);
 	return renameInput ? inputName : input->getInputName();
 }
 
 unsigned int OffsetInput::getInputLine() const {
+	returnBuffer(input);
 	return input->getInputLine() + offset;
 }
 
 unsigned int OffsetInput::getInputPos() const {
+	returnBuffer(input);
 	return input->getInputPos();
 }
 
 std::string OffsetInput::getCurrentLine() {
+	returnBuffer(input);
+	resetBuffer();
 	return input->getCurrentLine();
 }
 
 unsigned int OffsetInput::getCurrentLinePos() const {
+	returnBuffer(input);
 	return input->getCurrentLinePos();
 }
 
 void OffsetInput::markPosition() {
+	returnBuffer(input);
 	input->markPosition();
 }
 
 void OffsetInput::rollback(unsigned int usedChars) {
+	returnBuffer(input);
+	resetBuffer();
 	input->rollback(usedChars);
 }
 
 void OffsetInput::setInputPos(unsigned int pos) {
+	returnBuffer(input);
+	resetBuffer();
 	input->setInputPos(pos);
 }
 
-char OffsetInput::readChar() {
-	return input->nextChar();
+bool OffsetInput::fetchBuffer() {
+	return borrowBuffer(input);
 }
@@ -33,6 +33,18 @@ ParsingTree::Node *Parser::parseWithErrorRecovery(ParserErrorList & errorList) {
 	return parserTable->parseWithErrorRecovery(scanner, parserAction, errorList);
 }
 
+ParsingTree::Node *Parser::parse(const TokenTable & tokens) {
+	assert(parserTable);
+	return parserTable->parse(tokens, parserAction);
+}
+
+ParsingTree::Node *Parser::parseWithErrorRecovery(const TokenTable & tokens,
+		ParserErrorList & errorList) {
+	
+	assert(parserTable);
+	return parserTable->parseWithErrorRecovery(tokens, parserAction, errorList);
+}
+
 Scanner *Parser::getScanner() const {
 	return scanner;
 }
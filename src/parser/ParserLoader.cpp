@@ -18,8 +18,23 @@ enum TableType {
 	TABLE_SLR1 = 1
 };
 
+// the first word of an automata buffer is the number of states in the old
+// format, with one row for each of the 128 ASCii characters, so the newer
+// formats have the high bit set
+const uint32_t AUTOMATA_FORMAT_ROWS = 0x80000002;
+const uint32_t AUTOMATA_FORMAT_KEYWORDS = 0x80000003;
+const uint32_t AUTOMATA_FORMAT_MASK = 0x80000000;
+
+const unsigned int OLD_ALPHABET_SIZE = 128;
+
 ParserLoader::ParserLoader() {}
 
+/*****************************************************************************
+ * Automata load functions
+ *****************************************************************************/
+static Automata *loadAutomataRows(const unsigned char *buffer, unsigned int & pos);
+static Automata *loadAutomataASCii(const unsigned char *buffer, unsigned int & pos);
+
 /*****************************************************************************
  * Parser load functions
  *****************************************************************************/
@@ -65,17 +80,80 @@ static void writeToBuffer(void *buffer, unsigned int & pos, const void *bufValue
 // See ParserLoader::automataToBuffer for buffer format
 ScannerAutomata *ParserLoader::bufferToAutomata(const unsigned char *buffer) {
 	unsigned int pos = 0;
+	uint32_t format = readFromBuffer<uint32_t>(buffer, pos);
+	
+	Automata *automata;
+	if (format & AUTOMATA_FORMAT_MASK) {
+		assert(format == AUTOMATA_FORMAT_ROWS || format == AUTOMATA_FORMAT_KEYWORDS);
+		automata = loadAutomataRows(buffer, pos);
+	}
+	else {
+		pos = 0;
+		automata = loadAutomataASCii(buffer, pos);
+	}
+	
+	ScannerAutomata *scannerAutomata = new ScannerAutomata(automata);
+	
+	unsigned int numIgnoredTokens = readFromBuffer<uint32_t>(buffer, pos);
+	for (unsigned int i = 0; i < numIgnoredTokens; ++i) {
+		unsigned int ignored = readFromBuffer<uint32_t>(buffer, pos);
+		scannerAutomata->addIgnoredToken(ignored);
+	}
+	
+	if (format == AUTOMATA_FORMAT_KEYWORDS) {
+		unsigned int numKeywords = readFromBuffer<uint32_t>(buffer, pos);
+		
+		std::vector<TokenTypeID> tokenTypeIds(numKeywords);
+		std::vector<TokenTypeID> keywordIds(numKeywords);
+		for (unsigned int i = 0; i < numKeywords; ++i) {
+			tokenTypeIds[i] = readFromBuffer<uint32_t>(buffer, pos);
+		}
+		for (unsigned int i = 0; i < numKeywords; ++i) {
+			keywordIds[i] = readFromBuffer<uint32_t>(buffer, pos);
+		}
+		
+		for (unsigned int i = 0; i < numKeywords; ++i) {
+			std::string keyword = readFromBuffer<std::string>(buffer, pos);
+			scannerAutomata->addKeyword(tokenTypeIds[i], keyword, keywordIds[i]);
+		}
+	}
+	
+	return scannerAutomata;
+}
+
+// the rows are stored as they are in memory, without padding
+static Automata *loadAutomataRows(const unsigned char *buffer, unsigned int & pos) {
+	unsigned int numStates = readFromBuffer<uint32_t>(buffer, pos);
+	unsigned int numClasses = readFromBuffer<uint32_t>(buffer, pos);
+	unsigned int entrySize = readFromBuffer<uint32_t>(buffer, pos);
+	
+	const unsigned char *inputClasses = buffer + pos;
+	pos += ALPHABET_SIZE;
+	
+	Automata *automata = new Automata(inputClasses, buffer + pos, entrySize, numClasses, numStates);
+	
+	// the table is padded to 4 bytes
+	unsigned int tableSize = numStates * (numClasses + 1) * entrySize;
+	pos += (tableSize + 3) / 4 * 4;
+	
+	return automata;
+}
+
+// the format used before the input classes, the token ids are stored as
+// the values of the final states
+static Automata *loadAutomataASCii(const unsigned char *buffer, unsigned int & pos) {
 	unsigned int numStates = readFromBuffer<uint32_t>(buffer, pos);
 	unsigned int finalStatesSize = numStates / 32 + (numStates % 32 == 0 ? 0 : 1);
 	
-	// read the transitions
+	// read the transitions, the other characters have no transitions
 	int **transitions;
 	transitions = new int *[ALPHABET_SIZE];
 	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) {
 		transitions[i] = new int[numStates];
 		
 		for (unsigned int j = 0; j < numStates; ++j) {
-			transitions[i][j] = readFromBuffer<int32_t>(buffer, pos);
+			if (i < OLD_ALPHABET_SIZE) transitions[i][j] = readFromBuffer<int32_t>(buffer, pos);
+			else transitions[i][j] = -1;
 		}
 	}
 	Automata *automata = new Automata(transitions, numStates);
@@ -96,21 +174,13 @@ ScannerAutomata *ParserLoader::bufferToAutomata(const unsigned char *buffer) {
 		}
 	}
 	
-	ScannerAutomata *scannerAutomata = new ScannerAutomata(automata);
-	
 	// read stateTokenTypeId
 	for (unsigned int i = 0; i < numStates; ++i) {
 		int tokenId = readFromBuffer<int32_t>(buffer, pos);
-		if (tokenId != -1) scannerAutomata->setStateTokenTypeId(i, tokenId);
-	}
-	
-	unsigned int numIgnoredTokens = readFromBuffer<uint32_t>(buffer, pos);
-	for (unsigned int i = 0; i < numIgnoredTokens; ++i) {
-		unsigned int ignored = readFromBuffer<uint32_t>(buffer, pos);
-		scannerAutomata->addIgnoredToken(ignored);
+		if (tokenId != -1) automata->setFinalStateValue(i, tokenId);
 	}
 	
-	return scannerAutomata;
+	return automata;
 }
 
 // See ParserLoader::tableToBuffer for buffer format
@@ -184,16 +254,25 @@ void ParserLoader::loadBuffer(const unsigned char *buffer, Grammar **grammar,
 /*
  * Buffer format:
  * struct {
+ * 		uint32_t format; // AUTOMATA_FORMAT_ROWS or AUTOMATA_FORMAT_KEYWORDS
  * 		uint32_t numStates;
- * 		int32_t transitions[ALPHABET_SIZE][numStates];
+ * 		uint32_t numClasses;
+ * 		uint32_t entrySize; // 1, 2 or 4 bytes
+ * 		uint8_t inputClasses[ALPHABET_SIZE];
  * 		
- * 		// each bit is one boolean
- * 		uint32_t finalStates[numStates / 32 + (numStates % 32 == 0 ? 0 : 1)];
- * 		
- * 		int32_t stateTokenTypeId[numStates];
+ * 		// the rows of Automata::getTransitionTable() without the padding,
+ * 		// the value of each final state is its token id
+ * 		uintN_t rows[numStates][numClasses + 1];
+ * 		uint8_t padding[]; // the rows are padded to 4 bytes
  * 		
  * 		uint32_t numIgnoredTokens;
  * 		uint32_t ignoredTokens[numIgnoredTokens];
+ * 		
+ * 		// only with the format AUTOMATA_FORMAT_KEYWORDS, used when there are keywords
+ * 		uint32_t numKeywords;
+ * 		uint32_t keywordTokenTypeIds[numKeywords];
+ * 		uint32_t keywordIds[numKeywords];
+ * 		const char *keywords[numKeywords]; // null-terminated string
  * };
  */
 unsigned char *ParserLoader::automataToBuffer(const ScannerAutomata *scannerAutomata,
@@ -201,50 +280,52 @@ unsigned char *ParserLoader::automataToBuffer(const ScannerAutomata *scannerAuto
 	Automata *automata = scannerAutomata->getAutomata();
 	
 	unsigned int numStates = automata->getNumStates();
-	unsigned int finalStatesSize = numStates / 32 + (numStates % 32 == 0 ? 0 : 1);
+	unsigned int numClasses = automata->getNumClasses();
+	unsigned int entrySize = automata->getEntrySize();
+	
+	unsigned int rowBytes = (numClasses + 1) * entrySize;
+	unsigned int tableSize = (numStates * rowBytes + 3) / 4 * 4;
 	
 	const ScannerAutomata::TokenTypeIDSet & ignoredTokens = scannerAutomata->getIgnoredTokens();
 	unsigned int numIgnoredTokens = ignoredTokens.size();
 	
-	*bufferSize = sizeof(uint32_t); // numStates
-	*bufferSize += sizeof(int32_t) * ALPHABET_SIZE * numStates; // transitions
-	*bufferSize += sizeof(uint32_t) * finalStatesSize; // finalStates
-	*bufferSize += sizeof(int32_t) * numStates; // stateTokenTypeId
+	*bufferSize = sizeof(uint32_t); // format
+	*bufferSize += sizeof(uint32_t); // numStates
+	*bufferSize += sizeof(uint32_t); // numClasses
+	*bufferSize += sizeof(uint32_t); // entrySize
+	*bufferSize += sizeof(uint8_t) * ALPHABET_SIZE; // inputClasses
+	*bufferSize += tableSize; // rows
 	*bufferSize += sizeof(uint32_t); // numIgnoredTokens
 	*bufferSize += sizeof(uint32_t) * numIgnoredTokens; // ignoredTokens
 	
+	const KeywordTable & keywords = scannerAutomata->getKeywords();
+	unsigned int numKeywords = keywords.size();
+	
+	if (numKeywords) {
+		*bufferSize += sizeof(uint32_t); // numKeywords
+		*bufferSize += sizeof(uint32_t) * numKeywords; // keywordTokenTypeIds
+		*bufferSize += sizeof(uint32_t) * numKeywords; // keywordIds
+		for (unsigned int i = 0; i < numKeywords; ++i) {
+			*bufferSize += keywords.getKeyword(i).size() + 1; // keywords
+		}
+	}
+	
 	unsigned char *buffer = new unsigned char[*bufferSize];
 	unsigned int pos = 0;
 	
+	writeToBuffer(buffer, pos, numKeywords ? AUTOMATA_FORMAT_KEYWORDS : AUTOMATA_FORMAT_ROWS);
 	writeToBuffer(buffer, pos, (uint32_t)numStates);
+	writeToBuffer(buffer, pos, (uint32_t)numClasses);
+	writeToBuffer(buffer, pos, (uint32_t)entrySize);
+	writeToBuffer(buffer, pos, automata->getInputClasses(), ALPHABET_SIZE);
 	
-	// save the transitionTable
-	const int * const *transitionTable = automata->getTransitionTable();
-	for (unsigned int input = 0; input < ALPHABET_SIZE; ++input) {
-		for (unsigned int state = 0; state < numStates; ++state) {
-			writeToBuffer(buffer, pos, (int32_t)transitionTable[input][state]);
-		}
-	}
-	
-	// save the final states
-	unsigned int bit = 0;
-	uint32_t value = 0;
-	for (unsigned int i = 0; i < numStates; ++i) {
-		if (automata->isFinalState(i)) value |= 1 << bit;
-		++bit;
-		
-		if (bit >= 32) {
-			writeToBuffer(buffer, pos, value);
-			bit = 0;
-			value = 0;
-		}
+	// save the rows, without the padding of each row
+	const unsigned char *table = (const unsigned char *)automata->getTransitionTable();
+	for (unsigned int state = 0; state < numStates; ++state) {
+		writeToBuffer(buffer, pos, table + state * automata->getRowSize() * entrySize, rowBytes);
 	}
-	if (bit > 0) writeToBuffer(buffer, pos, value);
 	
-	// save stateTokenTypeId
-	for (unsigned int i = 0; i < numStates; ++i) {
-		writeToBuffer(buffer, pos, (int32_t)scannerAutomata->getStateTokenTypeId(i));
-	}
+	while (pos % 4) writeToBuffer(buffer, pos, (uint8_t)0);
 	
 	// save ignored tokens
 	writeToBuffer(buffer, pos, (uint32_t)numIgnoredTokens);
@@ -253,6 +334,20 @@ unsigned char *ParserLoader::automataToBuffer(const ScannerAutomata *scannerAuto
 		writeToBuffer(buffer, pos, (uint32_t)*it);
 	}
 	
+	// save keywords
+	if (numKeywords) {
+		writeToBuffer(buffer, pos, (uint32_t)numKeywords);
+		for (unsigned int i = 0; i < numKeywords; ++i) {
+			writeToBuffer(buffer, pos, (uint32_t)keywords.getTokenTypeId(i));
+		}
+		for (unsigned int i = 0; i < numKeywords; ++i) {
+			writeToBuffer(buffer, pos, (uint32_t)keywords.getKeywordId(i));
+		}
+		for (unsigned int i = 0; i < numKeywords; ++i) {
+			writeToBuffer(buffer, pos, keywords.getKeyword(i).c_str());
+		}
+	}
+	
 	assert(pos == *bufferSize);
 	
 	return buffer;
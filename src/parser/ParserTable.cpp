@@ -1,5 +1,8 @@
 #include "parser/ParserTable.h"
 
+#include "parser/Scanner.h"
+#include "parser/TokenTable.h"
+
 /*****************************************************************************
  * ParserTable::RuleBase
  *****************************************************************************/
@@ -41,6 +44,37 @@ std::ostream & operator<<(std::ostream & stream, const ParserTable::RuleBase & r
 	return stream;
 }
 
+/*****************************************************************************
+ * ParserTable::TokenReader
+ *****************************************************************************/
+ParserTable::TokenReader::TokenReader(Scanner *scan) : scanner(scan), tokens(NULL), index(0) {}
+
+ParserTable::TokenReader::TokenReader(const TokenTable *table) : scanner(NULL), tokens(table),
+		index(0) {}
+
+ParserTable::Token *ParserTable::TokenReader::nextToken() {
+	if (scanner) return scanner->nextToken();
+	
+	if (index >= tokens->size()) {
+		// past the end, the errors are at the end of the input
+		index = tokens->size() + 1;
+		return NULL;
+	}
+	
+	Token *token = new Token(tokens->getTokenTypeId(index), tokens->getToken(index),
+			tokens->getInputLocation(index), tokens->getInputPos(index));
+	++index;
+	
+	return token;
+}
+
+ParserError ParserTable::TokenReader::createError(const std::string & msg) const {
+	if (scanner) return ParserError(scanner->getInput(), msg);
+	
+	if (index == 0 || index > tokens->size()) return ParserError(tokens->getEndLocation(), msg);
+	return ParserError(tokens->getInputLocation(index - 1), msg);
+}
+
 /*****************************************************************************
  * ParserTable
  *****************************************************************************/
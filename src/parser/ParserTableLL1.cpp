@@ -69,7 +69,7 @@ bool ParserTableLL1::Rule::operator!=(const Rule & rule) const {
  * ParserTableLL1::ParsingContext
  *****************************************************************************/
 struct ParserTableLL1::ParsingContext {
-	ParsingContext(const ParserTableLL1 *table, Scanner *scan);
+	ParsingContext(const ParserTableLL1 *table, TokenReader & tokenReader);
 	~ParsingContext();
 	
 	// called when an error occurs
@@ -85,7 +85,7 @@ struct ParserTableLL1::ParsingContext {
 	
 	const ParserTableLL1 *parserTable;
 	
-	Scanner *scanner;
+	TokenReader & reader;
 	
 	Token *nextToken;
 	
@@ -96,12 +96,12 @@ struct ParserTableLL1::ParsingContext {
 };
 
 ParserTableLL1::ParsingContext::ParsingContext(const ParserTableLL1 *table,
-		Scanner *scan) : parserTable(table), scanner(scan), hasError(false) {
+		TokenReader & tokenReader) : parserTable(table), reader(tokenReader), hasError(false) {
 	
 	root = new NonTerminal(parserTable->getRootNonTerminalId());
 	nodeStack.push(root);
 	
-	nextToken = scanner->nextToken();
+	nextToken = reader.nextToken();
 }
 
 ParserTableLL1::ParsingContext::~ParsingContext() {
@@ -109,8 +109,6 @@ ParserTableLL1::ParsingContext::~ParsingContext() {
 }
 
 void ParserTableLL1::ParsingContext::cleanUp() {
-	// do not delete the scanner, it will be deleted in the Parser destructor
-	
 	while (!nodeStack.empty()) nodeStack.pop();
 	
 	delete(root);
@@ -123,7 +121,7 @@ void ParserTableLL1::ParsingContext::cleanUp() {
 void ParserTableLL1::ParsingContext::errorOccurredEOF(ParserErrorList *errorList) {
 	hasError = true;
 	
-	ParserError error(scanner->getInput(), "Unexpected end of file.");
+	ParserError error = reader.createError("Unexpected end of file.");
 	
 	if (errorList) errorList->push_back(error);
 	else {
@@ -137,7 +135,7 @@ void ParserTableLL1::ParsingContext::errorOccurredExpectingToken(ParserErrorList
 	
 	hasError = true;
 	
-	ParserError error(scanner->getInput(), "Unexpected token: " + nextToken->getToken());
+	ParserError error = reader.createError("Unexpected token: " + nextToken->getToken());
 	
 	if (errorList) {
 		errorList->push_back(error);
@@ -145,7 +143,7 @@ void ParserTableLL1::ParsingContext::errorOccurredExpectingToken(ParserErrorList
 		// error recovery
 		do {
 			delete(nextToken);
-			nextToken = scanner->nextToken();
+			nextToken = reader.nextToken();
 		} while (nextToken && nextToken->getTokenTypeId() != expecting);
 	}
 	else {
@@ -158,7 +156,7 @@ void ParserTableLL1::ParsingContext::errorOccurredExpectingRule(ParserErrorList
 	
 	hasError = true;
 	
-	ParserError error(scanner->getInput(), "Unexpected token: " + nextToken->getToken());
+	ParserError error = reader.createError("Unexpected token: " + nextToken->getToken());
 	
 	if (errorList) {
 		errorList->push_back(error);
@@ -166,7 +164,7 @@ void ParserTableLL1::ParsingContext::errorOccurredExpectingRule(ParserErrorList
 		// error recovery
 		do {
 			delete(nextToken);
-			nextToken = scanner->nextToken();
+			nextToken = reader.nextToken();
 		} while (nextToken && !parserTable->getRule(topNt, nextToken));
 	}
 	else {
@@ -237,18 +235,33 @@ const ParserTableLL1::RuleList & ParserTableLL1::getRuleList() const {
 
 ParserTableLL1::Node *ParserTableLL1::parse(Scanner *scanner, ParserAction *action) const {
 	
-	return parse(scanner, action, NULL);
+	TokenReader reader(scanner);
+	return parse(reader, action, NULL);
 }
 
 ParserTableLL1::Node *ParserTableLL1::parseWithErrorRecovery(Scanner *scanner, ParserAction *action,
 				ParserErrorList & errorList) const {
 	
-	return parse(scanner, action, &errorList);
+	TokenReader reader(scanner);
+	return parse(reader, action, &errorList);
+}
+
+ParserTableLL1::Node *ParserTableLL1::parse(const TokenTable & tokens, ParserAction *action) const {
+	
+	TokenReader reader(&tokens);
+	return parse(reader, action, NULL);
+}
+
+ParserTableLL1::Node *ParserTableLL1::parseWithErrorRecovery(const TokenTable & tokens,
+		ParserAction *action, ParserErrorList & errorList) const {
+	
+	TokenReader reader(&tokens);
+	return parse(reader, action, &errorList);
 }
 
-ParserTableLL1::Node *ParserTableLL1::parse(Scanner *scanner, ParserAction *action, ParserErrorList *errorList) const {
+ParserTableLL1::Node *ParserTableLL1::parse(TokenReader & reader, ParserAction *action, ParserErrorList *errorList) const {
 	
-	ParsingContext context(this, scanner);
+	ParsingContext context(this, reader);
 	
 	while (!context.nodeStack.empty()) {
 		Node *stackTop = context.nodeStack.top();
@@ -267,7 +280,7 @@ ParserTableLL1::Node *ParserTableLL1::parse(Scanner *scanner, ParserAction *acti
 				context.nodeStack.pop();
 				
 				delete(context.nextToken);
-				context.nextToken = scanner->nextToken();
+				context.nextToken = reader.nextToken();
 			}
 			else {
 				context.errorOccurredExpectingToken(errorList, tokenTop->getTokenTypeId());
@@ -293,7 +306,7 @@ ParserTableLL1::Node *ParserTableLL1::parse(Scanner *scanner, ParserAction *acti
 	}
 	
 	if (context.nextToken) {
-		ParserError error(scanner->getInput(), std::string("Junk at the end of file: ") + context.nextToken->getToken());
+		ParserError error = reader.createError(std::string("Junk at the end of file: ") + context.nextToken->getToken());
 		if (errorList) errorList->push_back(error);
 		else {
 			context.cleanUp();
@@ -32,7 +32,7 @@ bool ParserTableSLR1::Rule::operator!=(const Rule & rule) const {
  * ParserTableSLR1::ParsingContext
  *****************************************************************************/
 struct ParserTableSLR1::ParsingContext {
-	ParsingContext(const ParserTableSLR1 *table, Scanner *scan, ParserAction *act);
+	ParsingContext(const ParserTableSLR1 *table, TokenReader & tokenReader, ParserAction *act);
 	~ParsingContext();
 	
 	void acceptToken();
@@ -52,7 +52,7 @@ struct ParserTableSLR1::ParsingContext {
 	
 	const ParserTableSLR1 *parserTable;
 	
-	Scanner *scanner;
+	TokenReader & reader;
 	ParserAction *parserAction;
 	
 	StateStack stack;
@@ -63,10 +63,10 @@ struct ParserTableSLR1::ParsingContext {
 };
 
 ParserTableSLR1::ParsingContext::ParsingContext(const ParserTableSLR1 *table,
-		Scanner *scan, ParserAction *act) : parserTable(table), scanner(scan),
+		TokenReader & tokenReader, ParserAction *act) : parserTable(table), reader(tokenReader),
 		parserAction(act) {
 	
-	nextToken = scanner->nextToken();
+	nextToken = reader.nextToken();
 	stack.push(0);
 }
 
@@ -77,7 +77,7 @@ ParserTableSLR1::ParsingContext::~ParsingContext() {
 void ParserTableSLR1::ParsingContext::acceptToken() {
 	assert(nextToken);
 	nodeStack.push(nextToken);
-	nextToken = scanner->nextToken();
+	nextToken = reader.nextToken();
 }
 
 void ParserTableSLR1::ParsingContext::popStates(unsigned int numStates) {
@@ -92,8 +92,6 @@ ParsingTree::Node *ParserTableSLR1::ParsingContext::getParsingTreeRoot() const {
 }
 
 void ParserTableSLR1::ParsingContext::cleanUp() {
-	// do not delete the scanner, it will be deleted in the Parser destructor
-	
 	while (!nodeStack.empty()) {
 		delete(nodeStack.top());
 		nodeStack.pop();
@@ -108,9 +106,9 @@ void ParserTableSLR1::ParsingContext::errorOccurred(ParserErrorList *errorList)
 	
 	if (nextToken) {
 		std::string tok = nextToken->getToken();
-		error = ParserError(scanner->getInput(), std::string("Unexpected token \"") + tok + "\".");
+		error = reader.createError(std::string("Unexpected token \"") + tok + "\".");
 	}
-	else error = ParserError(scanner->getInput(), "Unexpected end of file.");
+	else error = reader.createError("Unexpected end of file.");
 	
 	if (errorList) {
 		errorList->push_back(error);
@@ -118,7 +116,7 @@ void ParserTableSLR1::ParsingContext::errorOccurred(ParserErrorList *errorList)
 		// error recovery
 		do {
 			delete(nextToken);
-			nextToken = scanner->nextToken();
+			nextToken = reader.nextToken();
 		} while (nextToken && parserTable->getAction(stack.top(), nextToken).getType() == ERROR);
 	}
 	else {
@@ -325,19 +323,35 @@ ParserTableSLR1::Action **ParserTableSLR1::getActionTable() const {
 ParserTableSLR1::Node *ParserTableSLR1::parse(Scanner *scanner,
 		ParserAction *parserAction) const {
 	
-	return parse(scanner, parserAction, NULL);
+	TokenReader reader(scanner);
+	return parse(reader, parserAction, NULL);
 }
 
 ParserTableSLR1::Node *ParserTableSLR1::parseWithErrorRecovery(Scanner *scanner, ParserAction *parserAction,
 				ParserErrorList & errorList) const {
 	
-	return parse(scanner, parserAction, &errorList);
+	TokenReader reader(scanner);
+	return parse(reader, parserAction, &errorList);
+}
+
+ParserTableSLR1::Node *ParserTableSLR1::parse(const TokenTable & tokens,
+		ParserAction *parserAction) const {
+	
+	TokenReader reader(&tokens);
+	return parse(reader, parserAction, NULL);
+}
+
+ParserTableSLR1::Node *ParserTableSLR1::parseWithErrorRecovery(const TokenTable & tokens,
+		ParserAction *parserAction, ParserErrorList & errorList) const {
+	
+	TokenReader reader(&tokens);
+	return parse(reader, parserAction, &errorList);
 }
 
-ParserTableSLR1::Node *ParserTableSLR1::parse(Scanner *scanner, ParserAction *parserAction,
+ParserTableSLR1::Node *ParserTableSLR1::parse(TokenReader & reader, ParserAction *parserAction,
 		ParserErrorList *errorList) const {
 	
-	ParsingContext context(this, scanner, parserAction);
+	ParsingContext context(this, reader, parserAction);
 	
 	bool hasError = false;
 	
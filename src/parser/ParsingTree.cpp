@@ -98,22 +98,57 @@ InputLocation ParsingTree::NonTerminal::getInputLocation() const {
 /*****************************************************************************
  * ParsingTree::Token
  *****************************************************************************/
-ParsingTree::Token::Token(TokenTypeID id) : Node(NODE_TOKEN), tokenTypeId(id) {}
+// the text of the tokens constructed without one
+static const std::string emptyToken;
+
+ParsingTree::Token::Token(TokenTypeID id) : Node(NODE_TOKEN), tokenTypeId(id),
+		token(&emptyToken), ownToken(false), inputPos(0) {}
+
+ParsingTree::Token::Token(TokenTypeID id, const std::string & tok,
+		const InputLocation & location) : Node(NODE_TOKEN), tokenTypeId(id),
+		token(new std::string(tok)), ownToken(true), inputLocation(location), inputPos(0) {}
 
 ParsingTree::Token::Token(TokenTypeID id, const std::string & tok,
-		const InputLocation & location) : Node(NODE_TOKEN),
-		tokenTypeId(id), token(tok), inputLocation(location) {}
+		const InputLocation & location, unsigned int pos) : Node(NODE_TOKEN), tokenTypeId(id),
+		token(new std::string(tok)), ownToken(true), inputLocation(location), inputPos(pos) {}
+
+ParsingTree::Token::Token(TokenTypeID id, const std::string *pooledTok,
+		const InputLocation & location, unsigned int pos) : Node(NODE_TOKEN), tokenTypeId(id),
+		token(pooledTok), ownToken(false), inputLocation(location), inputPos(pos) {
+	assert(token);
+}
+
+ParsingTree::Token::Token(const Token & other) : Node(NODE_TOKEN), tokenTypeId(other.tokenTypeId),
+		token(other.ownToken ? new std::string(*other.token) : other.token),
+		ownToken(other.ownToken), inputLocation(other.inputLocation), inputPos(other.inputPos) {}
+
+ParsingTree::Token::~Token() {
+	if (ownToken) delete(token);
+}
 
 TokenTypeID ParsingTree::Token::getTokenTypeId() const {
 	return tokenTypeId;
 }
 
 const std::string & ParsingTree::Token::getToken() const {
-	return token;
+	return *token;
 }
 
 void ParsingTree::Token::setToken(const std::string & tok) {
-	token = tok;
+	// tok may be the text of this token
+	const std::string *newToken = new std::string(tok);
+	if (ownToken) delete(token);
+	
+	token = newToken;
+	ownToken = true;
+}
+
+const std::string *ParsingTree::Token::getPooledToken() const {
+	return ownToken || token == &emptyToken ? NULL : token;
+}
+
+unsigned int ParsingTree::Token::getInputPos() const {
+	return inputPos;
 }
 
 bool ParsingTree::Token::hasInputLocation() const {
@@ -125,9 +160,16 @@ InputLocation ParsingTree::Token::getInputLocation() const {
 }
 
 ParsingTree::Token & ParsingTree::Token::operator=(const Token & other) {
+	if (this == &other) return *this;
+	
 	tokenTypeId = other.tokenTypeId;
-	token = other.token;
+	
+	if (ownToken) delete(token);
+	token = other.ownToken ? new std::string(*other.token) : other.token;
+	ownToken = other.ownToken;
+	
 	inputLocation = other.inputLocation;
+	inputPos = other.inputPos;
 	
 	return *this;
 }
@@ -1,34 +1,200 @@
 #include "parser/Regex.h"
 
 #include "parser/Automata.h"
+#include "parser/AutomataOperations.h"
+#include "parser/DynamicAutomata.h"
+#include "parser/MutexLock.h"
+#include "parser/ParserDefs.h"
 #include "parser/RegexCompiler.h"
 
-Regex::Regex(const std::string & pattern) {
+#include <cassert>
+
+// locked while a regex prepares its first search
+static pthread_mutex_t searchMutex = PTHREAD_MUTEX_INITIALIZER;
+
+Regex::Regex(const std::string & pattern) : searchPrepared(0), searchAutomata(NULL) {
 	compile(pattern.c_str());
 }
 
-Regex::Regex(const char *pattern) {
+Regex::Regex(const char *pattern) : searchPrepared(0), searchAutomata(NULL) {
 	compile(pattern);
 }
 
-Regex::Regex(Automata *autom) : automata(autom) {}
+Regex::Regex(Automata *autom) : automata(autom), searchPrepared(0), searchAutomata(NULL) {}
 
-Regex::Regex(char c) {
-	automata = new Automata(2);
-	automata->setTransition(0, c, 1);
-	automata->setFinalState(1);
+Regex::Regex(char c) : searchPrepared(0), searchAutomata(NULL) {
+	Automata *autom = new Automata(2);
+	autom->setTransition(0, c, 1);
+	autom->setFinalState(1);
+	automata = autom;
 }
 
 Regex::~Regex() {
-	delete(automata);
+	delete(searchAutomata);
 }
 
 bool Regex::matches(const std::string & sentence) const {
 	return automata->accept(sentence.c_str());
 }
 
+bool Regex::search(const std::string & text, Match & match, unsigned int start) const {
+	prepareSearch();
+	
+	const char *chars = text.data();
+	unsigned int size = text.size();
+	if (start > size) return false;
+	
+	if (!prefix.empty()) {
+		// a match can start only where the prefix is found
+		std::string::size_type pos = start;
+		while ((pos = text.find(prefix, pos)) != std::string::npos) {
+			int length = matchAt(chars, size, pos);
+			if (length != -1) {
+				match.position = pos;
+				match.length = length;
+				return true;
+			}
+			++pos;
+		}
+		
+		return false;
+	}
+	
+	// find where the first match ends, the leftmost match starts before it
+	unsigned int end = start;
+	int state = 0;
+	while (!searchAutomata->isFinalState(state)) {
+		if (end == size) return false;
+		
+		state = searchAutomata->getTransition(state, chars[end++]);
+		assert(state != -1);
+	}
+	
+	bool emptyMatch = automata->isFinalState(0);
+	for (unsigned int pos = start; pos <= end; ++pos) {
+		if (!emptyMatch && (pos == size || automata->getTransition(0, chars[pos]) == -1)) continue;
+		
+		int length = matchAt(chars, size, pos);
+		if (length != -1) {
+			match.position = pos;
+			match.length = length;
+			return true;
+		}
+	}
+	
+	// the match that ends at end starts in the positions tried
+	assert(false);
+	return false;
+}
+
+void Regex::findAll(const std::string & text, MatchList & matches) const {
+	Match match;
+	unsigned int pos = 0;
+	
+	while (search(text, match, pos)) {
+		matches.push_back(match);
+		pos = match.position + (match.length ? match.length : 1);
+	}
+}
+
+void Regex::split(const std::string & text, MatchList & pieces) const {
+	Match match;
+	Match piece;
+	piece.position = 0;
+	unsigned int pos = 0;
+	
+	while (search(text, match, pos)) {
+		if (!match.length) {
+			pos = match.position + 1;
+			continue;
+		}
+		
+		piece.length = match.position - piece.position;
+		pieces.push_back(piece);
+		
+		piece.position = match.position + match.length;
+		pos = piece.position;
+	}
+	
+	piece.length = text.size() - piece.position;
+	pieces.push_back(piece);
+}
+
+const std::string & Regex::getPrefix() const {
+	prepareSearch();
+	return prefix;
+}
+
+int Regex::matchAt(const char *text, unsigned int size, unsigned int pos) const {
+	int length = automata->isFinalState(0) ? 0 : -1;
+	
+	int state = 0;
+	for (unsigned int i = pos; i < size; ++i) {
+		state = automata->getTransition(state, text[i]);
+		if (state == -1) break;
+		if (automata->isFinalState(state)) length = i + 1 - pos;
+	}
+	
+	return length;
+}
+
+void Regex::prepareSearch() const {
+	// the atomic read is a barrier, the prefix and the automata set by
+	// other thread are seen after it
+	if (__sync_fetch_and_add(&searchPrepared, 0)) return;
+	
+	MutexLock lock(searchMutex);
+	if (searchPrepared) return;
+	
+	buildSearch();
+	
+	__sync_synchronize();
+	searchPrepared = 1;
+}
+
+void Regex::buildSearch() const {
+	// follow the only transition of each state until a final state
+	unsigned int state = 0;
+	for (unsigned int i = 0; i < automata->getNumStates() && !automata->isFinalState(state); ++i) {
+		unsigned int numTransitions = 0;
+		int next = -1;
+		char input = '\0';
+		
+		for (unsigned int c = 0; c < ALPHABET_SIZE && numTransitions < 2; ++c) {
+			int target = automata->getTransition(state, c);
+			if (target != -1) {
+				++numTransitions;
+				next = target;
+				input = c;
+			}
+		}
+		
+		if (numTransitions != 1) break;
+		
+		prefix.push_back(input);
+		state = next;
+	}
+	
+	if (!prefix.empty()) return;
+	
+	// any characters followed by the regex
+	DynamicAutomata *any = new DynamicAutomata();
+	DynamicAutomata::State *initialState = any->getInitialState();
+	initialState->setFinalState(true);
+	for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) initialState->addTransition(c, initialState);
+	
+	DynamicAutomata *regex = new DynamicAutomata(automata);
+	DynamicAutomata *unanchored = AutomataOperations::automataConcatenation(any, regex);
+	unanchored->determineAndMinimize();
+	searchAutomata = unanchored->toAutomata();
+	
+	delete(any);
+	delete(regex);
+	delete(unanchored);
+}
+
 void Regex::compile(const char *pattern) {
-	automata = RegexCompiler::getInstance()->compile(pattern);
+	automata = RegexCompiler::getInstance()->getAutomata(pattern);
 }
 
 const Automata *Regex::getAutomata() const {
@@ -5,6 +5,7 @@
 #include "parser/DynamicAutomata.h"
 #include "parser/Grammar.h"
 #include "parser/MemoryInput.h"
+#include "parser/MutexLock.h"
 #include "parser/Parser.h"
 #include "parser/ParserDefs.h"
 #include "parser/RegexBufferGrammar.h"
@@ -22,13 +23,19 @@ typedef ParsingTree::Node Node;
 typedef ParsingTree::NonTerminal NonTerminal;
 typedef ParsingTree::Token Token;
 
+static pthread_once_t instanceOnce = PTHREAD_ONCE_INIT;
+
 RegexCompiler *RegexCompiler::getInstance() {
-	if (!instance)
-		instance = new RegexCompiler();
+	pthread_once(&instanceOnce, createInstance);
 	return instance;
 }
 
-RegexCompiler::RegexCompiler() {
+void RegexCompiler::createInstance() {
+	instance = new RegexCompiler();
+}
+
+RegexCompiler::RegexCompiler() : cacheSize(DEFAULT_CACHE_SIZE), cacheHits(0), cacheMisses(0) {
+	pthread_mutex_init(&cacheMutex, NULL);
 	predefinedSets = createPredefinedSets();
 	
 #ifdef USE_PROCEDURAL_GRAMMAR
@@ -42,6 +49,7 @@ RegexCompiler::RegexCompiler() {
 }
 
 RegexCompiler::~RegexCompiler() {
+	pthread_mutex_destroy(&cacheMutex);
 	delete(regexGrammar);
 }
 
@@ -64,6 +72,74 @@ Automata *RegexCompiler::compile(const char *pattern) const {
 	return automata;
 }
 
+Pointer<const Automata> RegexCompiler::getAutomata(const std::string & pattern) {
+	{
+		MutexLock lock(cacheMutex);
+		
+		AutomataCache::iterator it = cache.find(pattern);
+		if (it != cache.end()) {
+			++cacheHits;
+			cacheUses.splice(cacheUses.begin(), cacheUses, it->second.use);
+			return it->second.automata;
+		}
+		
+		++cacheMisses;
+	}
+	
+	Pointer<const Automata> automata = compile(pattern.c_str());
+	
+	MutexLock lock(cacheMutex);
+	if (!cacheSize) return automata;
+	
+	// another thread may have compiled the same pattern
+	AutomataCache::iterator it = cache.find(pattern);
+	if (it != cache.end()) return it->second.automata;
+	
+	cacheUses.push_front(pattern);
+	CacheEntry & entry = cache[pattern];
+	entry.automata = automata;
+	entry.use = cacheUses.begin();
+	
+	removeOldPatterns();
+	return automata;
+}
+
+unsigned int RegexCompiler::getCacheSize() const {
+	MutexLock lock(cacheMutex);
+	return cacheSize;
+}
+
+void RegexCompiler::setCacheSize(unsigned int size) {
+	MutexLock lock(cacheMutex);
+	
+	cacheSize = size;
+	removeOldPatterns();
+}
+
+void RegexCompiler::clearCache() {
+	MutexLock lock(cacheMutex);
+	
+	cache.clear();
+	cacheUses.clear();
+}
+
+unsigned int RegexCompiler::getCacheHits() const {
+	MutexLock lock(cacheMutex);
+	return cacheHits;
+}
+
+unsigned int RegexCompiler::getCacheMisses() const {
+	MutexLock lock(cacheMutex);
+	return cacheMisses;
+}
+
+void RegexCompiler::removeOldPatterns() {
+	while (cache.size() > cacheSize) {
+		cache.erase(cacheUses.back());
+		cacheUses.pop_back();
+	}
+}
+
 DynamicAutomata *RegexCompiler::getNodeAutomata(Node *node) const {
 	DynamicAutomata *automata = NULL;
 	
@@ -74,6 +74,7 @@ void RegexProceduralGrammar::createRegexScannerGrammar(Grammar *grammar) {
 	}
 	automata->setTransition(0, '\\', 1);
 	automata->setFinalState(2);
+	automata->compressAlphabet();
 	Regex *symbolRegex = new Regex(automata);
 	
 	scannerGrammar->addTokenType(new TokenType(TOKEN_SYMBOL, symbolRegex));
@@ -1,6 +1,10 @@
 #include "parser/Scanner.h"
 
 #include "parser/Input.h"
+#include "parser/MemoryInput.h"
+#include "parser/MmapInput.h"
+#include "parser/TokenPool.h"
+#include "parser/TokenTable.h"
 
 #include <cassert>
 
@@ -18,7 +22,47 @@ Scanner::~Scanner() {
 
 ParsingTree::Token *Scanner::nextToken() {
 	assert(input);
-	return automata->nextToken(input);
+	return automata->nextToken(input, tokenPool.getPtr());
+}
+
+unsigned int Scanner::nextTokens(TokenRecord *records, unsigned int size, bool locations) {
+	assert(input);
+	
+	unsigned int count = 0;
+	while (count < size && automata->nextToken(input, records[count], locations)) ++count;
+	
+	return count;
+}
+
+void Scanner::tokenizeAll(Input *in, TokenTable & tokens, unsigned int numThreads) const {
+	assert(in);
+	
+	// only these inputs have all their characters in a single buffer
+	if (!dynamic_cast<MemoryInput *>(in) && !dynamic_cast<MmapInput *>(in)) numThreads = 1;
+	
+	automata->tokenize(in, tokens, numThreads);
+}
+
+TokenChange Scanner::retokenize(Input *in, TokenTable & tokens, unsigned int editPos,
+		unsigned int removedChars, unsigned int insertedChars) const {
+	
+	assert(in);
+	
+	if (dynamic_cast<MemoryInput *>(in) || dynamic_cast<MmapInput *>(in))
+		return automata->retokenize(in, tokens, editPos, removedChars, insertedChars);
+	
+	// the other inputs are read again, all the tokens change
+	TokenChange change;
+	change.first = 0;
+	change.removed = tokens.size();
+	
+	TokenTable newTokens;
+	automata->tokenize(in, newTokens);
+	change.added = newTokens.size();
+	
+	tokens = newTokens;
+	
+	return change;
 }
 
 Input *Scanner::getInput() const {
@@ -32,3 +76,11 @@ void Scanner::setInput(Input *in) {
 const Pointer<ScannerAutomata> & Scanner::getScannerAutomata() const {
 	return automata;
 }
+
+void Scanner::setTokenPool(const Pointer<TokenPool> & pool) {
+	tokenPool = pool;
+}
+
+const Pointer<TokenPool> & Scanner::getTokenPool() const {
+	return tokenPool;
+}
@@ -3,18 +3,166 @@
 #include "parser/Automata.h"
 #include "parser/Input.h"
 #include "parser/InputLocation.h"
+#include "parser/TokenPool.h"
+#include "parser/TokenTable.h"
 
+#include <algorithm>
 #include <cstring>
 
+#include <pthread.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+typedef ScannerAutomata::SkipState SkipState;
+
+// the minimum number of characters tokenized by a thread
+#define MIN_CHUNK_SIZE (64 * 1024)
+
+// return the first character of [current, end) that leaves the state,
+// comparing the characters with the first N bytes of the skip state
+template<unsigned int N>
+static const char *skipCharacters(const SkipState & skip, const char *current, const char *end) {
+	bool until = skip.type == ScannerAutomata::SKIP_UNTIL;
+	
+#ifdef __AVX2__
+	__m256i bytes32[N];
+	for (unsigned int i = 0; i < N; ++i) bytes32[i] = _mm256_set1_epi8(skip.bytes[i]);
+	
+	for (; end - current >= 32; current += 32) {
+		__m256i chars = _mm256_loadu_si256((const __m256i *)current);
+		__m256i found = _mm256_cmpeq_epi8(chars, bytes32[0]);
+		for (unsigned int i = 1; i < N; ++i)
+			found = _mm256_or_si256(found, _mm256_cmpeq_epi8(chars, bytes32[i]));
+		
+		unsigned int mask = _mm256_movemask_epi8(found);
+		if (!until) mask = ~mask;
+		if (mask) return current + __builtin_ctz(mask);
+	}
+#endif
+	
+#ifdef __SSE2__
+	__m128i bytes16[N];
+	for (unsigned int i = 0; i < N; ++i) bytes16[i] = _mm_set1_epi8(skip.bytes[i]);
+	
+	for (; end - current >= 16; current += 16) {
+		__m128i chars = _mm_loadu_si128((const __m128i *)current);
+		__m128i found = _mm_cmpeq_epi8(chars, bytes16[0]);
+		for (unsigned int i = 1; i < N; ++i)
+			found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, bytes16[i]));
+		
+		unsigned int mask = _mm_movemask_epi8(found);
+		if (!until) mask = ~mask & 0xFFFF;
+		if (mask) return current + __builtin_ctz(mask);
+	}
+#endif
+	
+	for (; current < end; ++current) {
+		bool found = false;
+		for (unsigned int i = 0; i < N; ++i) found |= (unsigned char)*current == skip.bytes[i];
+		if (found == until) return current;
+	}
+	
+	return end;
+}
+
+static inline const char *skipCharacters(const SkipState & skip, const char *current,
+		const char *end) {
+	
+	// a state without exits stays until the end
+	if (!skip.numBytes) return end;
+	
+	// the bytes after numBytes repeat the first one, so comparing more is harmless
+	if (skip.numBytes == 1) return skipCharacters<1>(skip, current, end);
+	if (skip.numBytes == 2) return skipCharacters<2>(skip, current, end);
+	if (skip.numBytes <= 4) return skipCharacters<4>(skip, current, end);
+	return skipCharacters<ScannerAutomata::MAX_SKIP_BYTES>(skip, current, end);
+}
+
+// walk the characters of [current, end) in the automata table, until there is
+// no transition (state becomes -1, the character without transition is consumed)
+// or the end is reached
+template<class Entry>
+static inline const char *walkTable(const Entry *table, unsigned int rowSize,
+		const unsigned char *inputClasses, const SkipState *skipStates, int & state,
+		const char *current, const char *end, int & reconizedToken, const char *& tokenEnd) {
+	
+	unsigned int currentState = state;
+	const Entry *row = table + currentState * rowSize;
+	
+	while (current < end) {
+		unsigned int next = row[1 + inputClasses[(unsigned char)*current++]];
+		if (next == Automata::NO_TRANSITION) {
+			state = -1;
+			return current;
+		}
+		
+		if (next - 1 == currentState) {
+			// the state loops on itself, skip the characters that stay in it
+			if (skipStates[currentState].type != ScannerAutomata::SKIP_NONE)
+				current = skipCharacters(skipStates[currentState], current, end);
+			
+			// the token of the state was already recognized
+			if (row[0] != Automata::NOT_FINAL) tokenEnd = current;
+			continue;
+		}
+		
+		currentState = next - 1;
+		row = table + currentState * rowSize;
+		
+		// the first entry of the row is the token recognized in the state
+		if (row[0] != Automata::NOT_FINAL) {
+			assert(row[0] >= Automata::FINAL_VALUE);
+			
+			reconizedToken = row[0] - Automata::FINAL_VALUE;
+			tokenEnd = current;
+		}
+	}
+	
+	state = currentState;
+	return current;
+}
+
+// read the next length characters of the input
+static void readToken(Input *input, unsigned int length, std::string & tokenName) {
+	tokenName.clear();
+	tokenName.reserve(length);
+	
+	while (tokenName.size() < length) {
+		const char *buf = NULL;
+		unsigned int size = input->getBuffer(buf);
+		assert(size);
+		
+		if (size > length - tokenName.size()) size = length - tokenName.size();
+		tokenName.append(buf, size);
+		input->consumeBuffer(size);
+	}
+}
+
+// move a location through the characters of [current, end)
+static inline void followLocation(const char *current, const char *end, unsigned int & line,
+		unsigned int & column) {
+	
+	const char *newLine;
+	while ((newLine = (const char *)memchr(current, '\n', end - current))) {
+		++line;
+		column = 0;
+		current = newLine + 1;
+	}
+	column += end - current;
+}
+
 ScannerAutomata::ScannerAutomata(Automata *a) : automata(a) {
-	unsigned int numStates = automata->getNumStates();
-	stateTokenTypeId = new int[numStates];
-	for (unsigned int i = 0; i < numStates; ++i) stateTokenTypeId[i] = -1;
+	findSkipStates();
 }
 
 ScannerAutomata::~ScannerAutomata() {
 	delete(automata);
-	delete[](stateTokenTypeId);
 }
 
 Automata *ScannerAutomata::getAutomata() const {
@@ -29,59 +177,192 @@ const ScannerAutomata::TokenTypeIDSet & ScannerAutomata::getIgnoredTokens() cons
 	return ignoredTokens;
 }
 
+void ScannerAutomata::addKeyword(TokenTypeID tokenTypeId, const std::string & keyword,
+		TokenTypeID keywordId) {
+	
+	keywords.addKeyword(tokenTypeId, keyword, keywordId);
+}
+
+const KeywordTable & ScannerAutomata::getKeywords() const {
+	return keywords;
+}
+
 int ScannerAutomata::getStateTokenTypeId(unsigned int state) const {
 	assert(state < automata->getNumStates());
-	return stateTokenTypeId[state];
+	return automata->getFinalStateValue(state);
 }
 
 void ScannerAutomata::setStateTokenTypeId(unsigned int state, TokenTypeID tokenId) {
 	assert(state < automata->getNumStates());
 	assert(automata->isFinalState(state));
-	stateTokenTypeId[state] = tokenId;
+	automata->setFinalStateValue(state, tokenId);
+}
+
+const ScannerAutomata::SkipState & ScannerAutomata::getSkipState(unsigned int state) const {
+	assert(state < skipStates.size());
+	return skipStates[state];
+}
+
+void ScannerAutomata::findSkipStates() {
+	unsigned int numStates = automata->getNumStates();
+	skipStates.resize(numStates);
+	
+	for (unsigned int state = 0; state < numStates; ++state) {
+		SkipState & skip = skipStates[state];
+		skip.type = SKIP_NONE;
+		skip.numBytes = 0;
+		
+		unsigned char loopBytes[ALPHABET_SIZE];
+		unsigned char exitBytes[ALPHABET_SIZE];
+		unsigned int numLoopBytes = 0;
+		unsigned int numExitBytes = 0;
+		
+		for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+			if (automata->getTransition(state, c) == (int)state) loopBytes[numLoopBytes++] = c;
+			else exitBytes[numExitBytes++] = c;
+		}
+		
+		if (!numLoopBytes) continue;
+		
+		if (numLoopBytes <= MAX_SKIP_BYTES) {
+			skip.type = SKIP_WHILE;
+			skip.numBytes = numLoopBytes;
+			memcpy(skip.bytes, loopBytes, numLoopBytes);
+		}
+		else if (numExitBytes <= MAX_SKIP_BYTES) {
+			skip.type = SKIP_UNTIL;
+			skip.numBytes = numExitBytes;
+			memcpy(skip.bytes, exitBytes, numExitBytes);
+		}
+		else continue;
+		
+		for (unsigned int i = skip.numBytes; i < MAX_SKIP_BYTES; ++i) skip.bytes[i] = skip.bytes[0];
+	}
+}
+
+const char *ScannerAutomata::walkAutomata(int & state, const char *current, const char *end,
+		int & reconizedToken, const char *& tokenEnd) const {
+	
+	const void *table = automata->getTransitionTable();
+	unsigned int rowSize = automata->getRowSize();
+	const unsigned char *inputClasses = automata->getInputClasses();
+	const SkipState *skip = skipStates.empty() ? NULL : &skipStates[0];
+	
+	// walk the table with the entry size of the automata
+	switch (automata->getEntrySize()) {
+		case 1:
+			return walkTable((const uint8_t *)table, rowSize, inputClasses, skip, state,
+					current, end, reconizedToken, tokenEnd);
+		case 2:
+			return walkTable((const uint16_t *)table, rowSize, inputClasses, skip, state,
+					current, end, reconizedToken, tokenEnd);
+		default:
+			return walkTable((const uint32_t *)table, rowSize, inputClasses, skip, state,
+					current, end, reconizedToken, tokenEnd);
+	}
 }
 
-ParsingTree::Token *ScannerAutomata::nextToken(Input *input) const {
+ParsingTree::Token *ScannerAutomata::nextToken(Input *input, TokenPool *pool) const {
+	TokenRecord record;
+	const char *chars;
+	unsigned int scanEnd;
+	if (!nextRecord(input, record, true, chars, scanEnd)) return NULL;
+	
+	InputLocation inputLocation(input->getInputName(), record.line, record.column);
+	
+	std::string tokenName;
+	if (!chars) {
+		// the start of the token is the marked position, read it again
+		input->rollback(0);
+		readToken(input, record.length, tokenName);
+		chars = tokenName.data();
+	}
+	
+	if (pool) {
+		// the pool copies the characters only the first time
+		const std::string *pooledToken = pool->intern(chars, record.length);
+		return new ParsingTree::Token(record.tokenTypeId, pooledToken, inputLocation,
+				record.inputPos);
+	}
+	
+	if (tokenName.empty()) tokenName.assign(chars, record.length);
+	return new ParsingTree::Token(record.tokenTypeId, tokenName, inputLocation, record.inputPos);
+}
+
+bool ScannerAutomata::nextToken(Input *input, TokenRecord & record, bool location) const {
+	const char *chars;
+	unsigned int scanEnd;
+	return nextRecord(input, record, location, chars, scanEnd);
+}
+
+bool ScannerAutomata::nextRecord(Input *input, TokenRecord & record, bool location,
+		const char *& chars, unsigned int & scanEnd) const {
+	
 	int reconizedToken;
-	std::string buffer;
 	unsigned int tokenUsedChars;
-	
-	InputLocation inputLocation;
+	scanEnd = 0;
 	
 	do {
-		inputLocation = input->getCurrentLocation();
+		record.inputPos = input->getInputPos();
+		if (location) {
+			record.line = input->getInputLine();
+			record.column = input->getCurrentLinePos();
+		}
 		
 		int state = 0;
 		
-		buffer.clear();
-		
 		tokenUsedChars = 0;
 		reconizedToken = -1;
 		
 		unsigned int usedChars = 0;
 		char lastChar = '\0';
 		
+		// the characters of the token while they are in the first window
+		const char *tokenStart = NULL;
+		unsigned int windows = 0;
+		
 		input->markPosition();
 		
 		while (state != -1) {
-			lastChar = input->nextChar();
-			++usedChars;
-			buffer.push_back(lastChar);
+			const char *begin = NULL;
+			unsigned int size = input->getBuffer(begin);
 			
-			state = automata->getTransition(state, lastChar);
-			if (state == -1) break;
+			if (!windows++) tokenStart = begin;
 			
-			if (automata->isFinalState(state)) {
-				int token = stateTokenTypeId[state];
-				assert(token != -1);
-				
-				reconizedToken = token;
-				tokenUsedChars = usedChars;
+			if (!size) {
+				// end of the input, no token can have a '\0'
+				lastChar = '\0';
+				if (record.inputPos + usedChars + 1 > scanEnd) scanEnd = record.inputPos + usedChars + 1;
+				break;
 			}
+			
+			// walk the characters that are in memory
+			const char *tokenEnd = NULL;
+			const char *current = walkAutomata(state, begin, begin + size,
+					reconizedToken, tokenEnd);
+			
+			unsigned int readEnd = record.inputPos + usedChars + (current - begin);
+			if (readEnd > scanEnd) scanEnd = readEnd;
+			
+			if (tokenEnd) tokenUsedChars = usedChars + (tokenEnd - begin);
+			lastChar = current[-1];
+			
+			if (state == -1 && tokenEnd) {
+				// the token ends in this window, the characters after it are left
+				// in the input instead of being read again after a rollback
+				usedChars = tokenUsedChars;
+				input->consumeBuffer(tokenEnd - begin);
+				break;
+			}
+			
+			unsigned int read = current - begin;
+			usedChars += read;
+			input->consumeBuffer(read);
 		}
 		
-		if (lastChar == '\0' && usedChars == 1) {
+		if (!usedChars) {
 			// end of file reached without reading any character
-			return NULL;
+			return false;
 		}
 		
 		if (reconizedToken == -1) {
@@ -90,17 +371,502 @@ ParsingTree::Token *ScannerAutomata::nextToken(Input *input) const {
 		
 		assert(tokenUsedChars > 0);
 		
-		if (usedChars != tokenUsedChars) input->rollback(tokenUsedChars);
+		chars = windows > 1 ? NULL : tokenStart;
+		
+		if (windows > 1 && keywords.mayBeKeyword(reconizedToken, tokenUsedChars)) {
+			// the first window may be gone, read the token again (the input ends after it)
+			std::string tokenName;
+			input->rollback(0);
+			readToken(input, tokenUsedChars, tokenName);
+			reconizedToken = keywords.classify(reconizedToken, tokenName.data(), tokenUsedChars);
+		}
+		else {
+			reconizedToken = keywords.classify(reconizedToken, tokenStart, tokenUsedChars);
+			if (usedChars != tokenUsedChars) input->rollback(tokenUsedChars);
+		}
 	} while (ignoredTokens.find(reconizedToken) != ignoredTokens.end());
 	
-	// use the usedChars first characters from buffer
-	assert(buffer.size() >= tokenUsedChars);
+	record.tokenTypeId = reconizedToken;
+	record.length = tokenUsedChars;
+	
+	return true;
+}
+
+void ScannerAutomata::tokenize(Input *input, TokenTable & tokens, unsigned int numThreads) const {
+	tokens.setInputName(input->getInputName());
+	tokens.clear();
+	
+	if (numThreads > 1) {
+		const char *buffer;
+		unsigned int size = input->getBuffer(buffer);
+		
+		unsigned int numChunks = size / MIN_CHUNK_SIZE;
+		if (numChunks > numThreads) numChunks = numThreads;
+		
+		if (numChunks > 1) {
+			tokenizeParallel(input, buffer, size, tokens, numChunks);
+			return;
+		}
+	}
+	
+	TokenRecord record;
 	std::string tokenName;
-	for (unsigned int i = 0; i < tokenUsedChars; ++i) {
-		tokenName.push_back(buffer[i]);
+	const char *chars;
+	
+	// the characters read since the last token added
+	unsigned int scanEnd = 0;
+	
+	// the location is followed through the characters of the tokens,
+	// asking it to the input for each token is slower
+	unsigned int line = input->getInputLine();
+	unsigned int column = input->getCurrentLinePos();
+	
+	while (true) {
+		const char *begin;
+		unsigned int size = input->getBuffer(begin);
+		if (!size) break;
+		
+		input->markPosition();
+		
+		int state = 0;
+		int reconizedToken = -1;
+		const char *tokenEnd = NULL;
+		const char *current = walkAutomata(state, begin, begin + size, reconizedToken, tokenEnd);
+		
+		// the token ended inside the window, no rollback is needed
+		if (state == -1 && reconizedToken != -1) {
+			unsigned int length = tokenEnd - begin;
+			reconizedToken = keywords.classify(reconizedToken, begin, length);
+			
+			unsigned int readEnd = input->getInputPos() + (current - begin);
+			if (readEnd > scanEnd) scanEnd = readEnd;
+			
+			if (ignoredTokens.find(reconizedToken) == ignoredTokens.end()) {
+				tokens.addToken(reconizedToken, input->getInputPos(), begin, length, line, column,
+						scanEnd);
+				scanEnd = 0;
+			}
+			
+			followLocation(begin, tokenEnd, line, column);
+			input->consumeBuffer(length);
+			continue;
+		}
+		
+		// the token may continue after the window or it's an error,
+		// read it using the fetched characters
+		unsigned int recordScanEnd;
+		if (!nextRecord(input, record, true, chars, recordScanEnd)) break;
+		if (recordScanEnd > scanEnd) scanEnd = recordScanEnd;
+		
+		// the start of the token is the marked position
+		input->rollback(0);
+		readToken(input, record.length, tokenName);
+		tokens.addToken(record.tokenTypeId, record.inputPos, tokenName.data(), record.length,
+				record.line, record.column, scanEnd);
+		scanEnd = 0;
+		
+		line = input->getInputLine();
+		column = input->getCurrentLinePos();
+	}
+	
+	tokens.setEndLocation(input->getCurrentLocation());
+}
+
+unsigned int ScannerAutomata::scanToken(const char *current, const char *end,
+		TokenTypeID & id, unsigned int & readChars) const {
+	
+	int state = 0;
+	int reconizedToken = -1;
+	const char *tokenEnd = NULL;
+	const char *last = walkAutomata(state, current, end, reconizedToken, tokenEnd);
+	
+	// an automata that didn't die would read the character after end
+	readChars = (last - current) + (state != -1);
+	
+	if (reconizedToken == -1) return 0;
+	
+	unsigned int length = tokenEnd - current;
+	id = keywords.classify(reconizedToken, current, length);
+	
+	return length;
+}
+
+ParserError ScannerAutomata::invalidToken(const std::string & inputName, const char *current,
+		const char *end, unsigned int line, unsigned int column) const {
+	
+	int state = 0;
+	int reconizedToken = -1;
+	const char *tokenEnd = NULL;
+	const char *last = walkAutomata(state, current, end, reconizedToken, tokenEnd);
+	
+	// the automata died in the last character read, or the input ended
+	char lastChar = state == -1 ? last[-1] : '\0';
+	
+	return ParserError(InputLocation(inputName, line, column),
+			std::string("Unexpected character \'") + lastChar + "\'.");
+}
+
+TokenChange ScannerAutomata::retokenize(Input *input, TokenTable & tokens, unsigned int editPos,
+		unsigned int removedChars, unsigned int insertedChars) const {
+	
+	unsigned int inputPos = input->getInputPos();
+	unsigned int line = input->getInputLine();
+	unsigned int column = input->getCurrentLinePos();
+	
+	const char *buffer = NULL;
+	unsigned int size = input->getBuffer(buffer);
+	
+	assert(editPos >= inputPos);
+	unsigned int editStart = editPos - inputPos;
+	unsigned int editEnd = editStart + insertedChars;
+	assert(editEnd <= size);
+	
+	// the first token that may change starts at or after the edit
+	const std::vector<unsigned int> & positions = tokens.getInputPositions();
+	unsigned int first = std::lower_bound(positions.begin(), positions.end(), editPos)
+			- positions.begin();
+	
+	// a token before the edit also changes if the characters read to find it
+	// reach the edit, the scan of a token can reach further than the scans of
+	// the tokens after it (like an unterminated comment read until the end)
+	for (unsigned int i = first; i > 0; --i) {
+		if (tokens.getScanEnd(i - 1) > editPos) first = i - 1;
+	}
+	
+	// start after the last token that doesn't change, at its end
+	unsigned int pos = 0;
+	if (first > 0) {
+		const char *chars = tokens.getTokenChars(first - 1);
+		unsigned int length = tokens.getLength(first - 1);
+		
+		pos = positions[first - 1] - inputPos + length;
+		line = tokens.getLine(first - 1);
+		column = tokens.getColumn(first - 1);
+		followLocation(chars, chars + length, line, column);
+	}
+	
+	// the tokens are read until one starts after the edit where a moved token
+	// starts, the tokens after it are the same
+	TokenTable added;
+	unsigned int locationPos = pos;
+	unsigned int next = first;
+	bool synchronized = false;
+	
+	// the characters read since the last token added
+	unsigned int scanEnd = 0;
+	
+	while (pos < size) {
+		if (pos >= editEnd) {
+			// the tokens that started in the removed characters or before
+			// pos are gone, the next one may start in pos
+			while (next < tokens.size() && (positions[next] - inputPos < editStart + removedChars
+					|| positions[next] - inputPos + insertedChars < pos + removedChars)) {
+				++next;
+			}
+			
+			synchronized = next < tokens.size()
+					&& positions[next] - inputPos + insertedChars == pos + removedChars;
+			if (synchronized) break;
+		}
+		
+		TokenTypeID id;
+		unsigned int readChars;
+		unsigned int length = scanToken(buffer + pos, buffer + size, id, readChars);
+		if (!length) {
+			followLocation(buffer + locationPos, buffer + pos, line, column);
+			throw invalidToken(input->getInputName(), buffer + pos, buffer + size, line, column);
+		}
+		
+		if (inputPos + pos + readChars > scanEnd) scanEnd = inputPos + pos + readChars;
+		
+		if (ignoredTokens.find(id) == ignoredTokens.end()) {
+			followLocation(buffer + locationPos, buffer + pos, line, column);
+			locationPos = pos;
+			added.addToken(id, inputPos + pos, buffer + pos, length, line, column, scanEnd);
+			scanEnd = 0;
+		}
+		
+		pos += length;
+	}
+	
+	followLocation(buffer + locationPos, buffer + pos, line, column);
+	input->consumeBuffer(size);
+	
+	TokenChange change;
+	change.first = first;
+	change.added = added.size();
+	
+	if (synchronized) {
+		// move the tokens after the ones read by the difference of their locations
+		change.removed = next - first;
+		
+		unsigned int oldLine = tokens.getLine(next);
+		int lineOffset = (int)line - (int)oldLine;
+		int columnOffset = (int)column - (int)tokens.getColumn(next);
+		
+		const InputLocation & end = tokens.getEndLocation();
+		tokens.setEndLocation(InputLocation(end.getName(), end.getLine() + lineOffset,
+				end.getLine() == oldLine ? end.getColumn() + columnOffset : end.getColumn()));
+		
+		tokens.moveTokens(next, (int)insertedChars - (int)removedChars, oldLine, lineOffset,
+				columnOffset);
+		
+		// the scan end of the first token moved also has the ignored tokens read
+		// before it, the scans of the tokens after it are the same
+		TokenTypeID id;
+		unsigned int readChars;
+		scanToken(buffer + pos, buffer + size, id, readChars);
+		if (inputPos + pos + readChars > scanEnd) scanEnd = inputPos + pos + readChars;
+		tokens.setScanEnd(next, scanEnd);
+	}
+	else {
+		change.removed = tokens.size() - first;
+		tokens.setEndLocation(InputLocation(tokens.getEndLocation().getName(), line, column));
+	}
+	
+	tokens.replaceTokens(first, change.removed, added);
+	
+	return change;
+}
+
+/*****************************************************************************
+ * Parallel tokenization
+ * 
+ * Each thread reads the tokens of a chunk from its start, guessing that a
+ * token starts there (the chunks start after a new line). When a token is
+ * invalid, the guess was wrong and the thread goes on from the next line.
+ * When the tokens are joined, the tokens of a chunk are used from the first
+ * one that starts where the previous token ends, until then the tokens are
+ * read again. If the guess was right, and it usually is, no token is read
+ * again.
+ *****************************************************************************/
+struct ScannerAutomata::Chunk {
+	const ScannerAutomata *scannerAutomata;
+	
+	const char *buffer;
+	unsigned int size;
+	
+	// the characters of the chunk in the buffer
+	unsigned int start;
+	unsigned int end;
+	
+	// a token read by the thread, it may be wrong
+	struct ChunkToken {
+		unsigned int pos;
+		unsigned int length;
+		TokenTypeID tokenTypeId;
+		bool ignored;
+		
+		// the characters read by the automata to find the token
+		unsigned int readChars;
+		
+		// the location from the start of the chunk
+		unsigned int line;
+		unsigned int column;
+	};
+	
+	std::vector<ChunkToken> tokens;
+	
+	// the new lines of the chunk
+	unsigned int numLines;
+	unsigned int lastLineStart;
+	
+	// the location of the start of the chunk
+	unsigned int line;
+	unsigned int column;
+	
+	// the index of the token that starts in pos or tokens.size()
+	unsigned int findToken(unsigned int pos) const {
+		unsigned int begin = 0;
+		unsigned int end = tokens.size();
+		
+		while (begin < end) {
+			unsigned int middle = (begin + end) / 2;
+			if (tokens[middle].pos < pos) begin = middle + 1;
+			else end = middle;
+		}
+		
+		if (begin < tokens.size() && tokens[begin].pos != pos) return tokens.size();
+		return begin;
+	}
+};
+
+void ScannerAutomata::tokenizeParallel(Input *input, const char *buffer, unsigned int size,
+		TokenTable & tokens, unsigned int numChunks) const {
+	
+	std::vector<Chunk> chunks(numChunks);
+	unsigned int chunkSize = size / numChunks;
+	
+	for (unsigned int i = 0; i < numChunks; ++i) {
+		Chunk & chunk = chunks[i];
+		chunk.scannerAutomata = this;
+		chunk.buffer = buffer;
+		chunk.size = size;
+		chunk.start = 0;
+		
+		if (i) {
+			// a token is likely to start after a new line
+			unsigned int start = i * chunkSize;
+			const char *newLine = (const char *)memchr(buffer + start, '\n', chunkSize);
+			chunk.start = newLine ? newLine + 1 - buffer : start;
+		}
+	}
+	
+	for (unsigned int i = 0; i < numChunks; ++i) {
+		chunks[i].end = i + 1 < numChunks ? chunks[i + 1].start : size;
+	}
+	
+	// the first chunk is read by this thread, if a thread can't be
+	// created its chunk is read by this thread too
+	std::vector<pthread_t> threads(numChunks);
+	std::vector<bool> started(numChunks, false);
+	
+	for (unsigned int i = 1; i < numChunks; ++i) {
+		started[i] = !pthread_create(&threads[i], NULL, tokenizeChunkThread, &chunks[i]);
 	}
 	
-	return new ParsingTree::Token(reconizedToken, tokenName, inputLocation);
+	tokenizeChunk(chunks[0]);
+	
+	for (unsigned int i = 1; i < numChunks; ++i) {
+		if (started[i]) pthread_join(threads[i], NULL);
+		else tokenizeChunk(chunks[i]);
+	}
+	
+	// find the location of the start of each chunk
+	chunks[0].line = input->getInputLine();
+	chunks[0].column = input->getCurrentLinePos();
+	
+	unsigned int numTokens = chunks[0].tokens.size();
+	for (unsigned int i = 1; i < numChunks; ++i) {
+		const Chunk & previous = chunks[i - 1];
+		
+		chunks[i].line = previous.line + previous.numLines;
+		if (previous.numLines) chunks[i].column = previous.end - previous.lastLineStart;
+		else chunks[i].column = previous.column + (previous.end - previous.start);
+		
+		numTokens += chunks[i].tokens.size();
+	}
+	
+	tokens.reserve(numTokens, size);
+	
+	unsigned int inputPos = input->getInputPos();
+	unsigned int pos = 0;
+	
+	// the characters read since the last token added
+	unsigned int scanEnd = 0;
+	
+	for (unsigned int i = 0; i < numChunks; ++i) {
+		const Chunk & chunk = chunks[i];
+		
+		// the location of the tokens read again
+		unsigned int locationPos = chunk.start;
+		unsigned int line = chunk.line;
+		unsigned int column = chunk.column;
+		
+		while (pos < chunk.end) {
+			unsigned int index = chunk.findToken(pos);
+			
+			if (index < chunk.tokens.size()) {
+				// the tokens of the chunk are right while they follow each other
+				for (; index < chunk.tokens.size() && chunk.tokens[index].pos == pos; ++index) {
+					const Chunk::ChunkToken & token = chunk.tokens[index];
+					pos += token.length;
+					
+					unsigned int readEnd = inputPos + token.pos + token.readChars;
+					if (readEnd > scanEnd) scanEnd = readEnd;
+					if (token.ignored) continue;
+					
+					tokens.addToken(token.tokenTypeId, inputPos + token.pos, buffer + token.pos,
+							token.length, chunk.line + token.line,
+							token.line ? token.column : chunk.column + token.column, scanEnd);
+					scanEnd = 0;
+				}
+				
+				continue;
+			}
+			
+			// read the token that starts in pos
+			TokenTypeID id;
+			unsigned int readChars;
+			unsigned int length = scanToken(buffer + pos, buffer + size, id, readChars);
+			if (!length) {
+				followLocation(buffer + locationPos, buffer + pos, line, column);
+				throw invalidToken(input->getInputName(), buffer + pos, buffer + size, line, column);
+			}
+			
+			if (inputPos + pos + readChars > scanEnd) scanEnd = inputPos + pos + readChars;
+			
+			if (ignoredTokens.find(id) == ignoredTokens.end()) {
+				followLocation(buffer + locationPos, buffer + pos, line, column);
+				locationPos = pos;
+				tokens.addToken(id, inputPos + pos, buffer + pos, length, line, column, scanEnd);
+				scanEnd = 0;
+			}
+			
+			pos += length;
+		}
+	}
+	
+	input->consumeBuffer(size);
+	tokens.setEndLocation(input->getCurrentLocation());
+}
+
+void ScannerAutomata::tokenizeChunk(Chunk & chunk) const {
+	const char *buffer = chunk.buffer;
+	
+	// the new lines of the whole chunk, the last token may end after it
+	chunk.numLines = 0;
+	
+	const char *current = buffer + chunk.start;
+	const char *end = buffer + chunk.end;
+	const char *newLine;
+	while ((newLine = (const char *)memchr(current, '\n', end - current))) {
+		++chunk.numLines;
+		current = newLine + 1;
+	}
+	chunk.lastLineStart = current - buffer;
+	
+	unsigned int pos = chunk.start;
+	unsigned int line = 0;
+	unsigned int column = 0;
+	
+	while (pos < chunk.end) {
+		Chunk::ChunkToken token;
+		token.pos = pos;
+		token.length = scanToken(buffer + pos, buffer + chunk.size, token.tokenTypeId,
+				token.readChars);
+		
+		unsigned int next = pos + token.length;
+		if (!token.length) {
+			// a wrong guess of the start of a token, try again in the next line
+			newLine = (const char *)memchr(buffer + pos, '\n', chunk.end - pos);
+			next = newLine ? newLine + 1 - buffer : chunk.end;
+		}
+		else {
+			token.ignored = ignoredTokens.find(token.tokenTypeId) != ignoredTokens.end();
+			token.line = line;
+			token.column = column;
+			chunk.tokens.push_back(token);
+		}
+		
+		followLocation(buffer + pos, buffer + next, line, column);
+		pos = next;
+	}
+
+}
+
+void *ScannerAutomata::tokenizeChunkThread(void *chunk) {
+	Chunk *c = (Chunk *)chunk;
+	
+	try {
+		c->scannerAutomata->tokenizeChunk(*c);
+	}
+	catch (...) {
+		// without memory for more tokens, the rest of the chunk is read
+		// again when the tokens are joined
+	}
+	
+	return NULL;
 }
 
 void ScannerAutomata::sanityCheck() const {
@@ -109,6 +875,7 @@ void ScannerAutomata::sanityCheck() const {
 
 bool ScannerAutomata::operator==(const ScannerAutomata & automata) const {
 	if (ignoredTokens != automata.ignoredTokens) return false;
+	if (keywords != automata.keywords) return false;
 	if (this->automata->getNumStates() != automata.automata->getNumStates()) return false;
 	
 	Automata::StateToState thisToOther;
@@ -116,7 +883,7 @@ bool ScannerAutomata::operator==(const ScannerAutomata & automata) const {
 	
 	unsigned int numStates = this->automata->getNumStates();
 	for (unsigned int i = 0; i < numStates; ++i) {
-		if (stateTokenTypeId[i] != automata.stateTokenTypeId[thisToOther[i]]) return false;
+		if (getStateTokenTypeId(i) != automata.getStateTokenTypeId(thisToOther[i])) return false;
 	}
 	
 	return true;
@@ -134,13 +901,21 @@ std::ostream & operator<<(std::ostream & stream, const ScannerAutomata & automat
 	}
 	stream << "\n";
 	
+	const KeywordTable & keywords = automata.keywords;
+	stream << "Keywords:";
+	for (unsigned int i = 0; i < keywords.size(); ++i) {
+		stream << " " << keywords.getKeyword(i) << "(" << keywords.getTokenTypeId(i)
+				<< " -> " << keywords.getKeywordId(i) << ")";
+	}
+	stream << "\n";
+	
 	stream << *automata.automata;
 	
 	stream << "Reconized:\n\t";
 	
 	unsigned int numStates = automata.automata->getNumStates();
 	for (unsigned int i = 0; i < numStates; ++i) {
-		stream << "\t" << automata.stateTokenTypeId[i];
+		stream << "\t" << automata.getStateTokenTypeId(i);
 	}
 	stream << "\n";
 	
@@ -7,6 +7,7 @@
 #include "parser/ScannerAutomata.h"
 
 #include <cassert>
+#include <map>
 
 /*****************************************************************************
  * ScannerGrammar
@@ -26,22 +27,34 @@ void ScannerGrammar::addTokenType(TokenType *tokenType) {
 ScannerAutomata *ScannerGrammar::compile(Grammar *g) const {
 	assert(!grammar.empty());
 	
+	TokenIDList tokenIds;
+	tokenIds.reserve(grammar.size());
+	for (TokenTypeList::const_iterator it = grammar.begin(); it != grammar.end(); ++it) {
+		tokenIds.push_back(g->getOrCreateTokenId((*it)->getTypeName()));
+	}
+	
+	// the keywords are not in the automata, they are found after it
+	KeywordList keywords;
+	findKeywords(tokenIds, keywords);
+	
 	DynamicAutomataVector dAutomataVector;
 	dAutomataVector.reserve(grammar.size());
 	
 	// maps the state to the token it reconize
 	StateToToken stateToken;
 	
-	for (TokenTypeList::const_iterator it = grammar.begin(); it != grammar.end(); ++it) {
-		DynamicAutomata *automata = new DynamicAutomata((*it)->getRegex()->getAutomata());
+	for (unsigned int i = 0; i < grammar.size(); ++i) {
+		if (keywords.find(i) != keywords.end()) continue;
+		
+		DynamicAutomata *automata = new DynamicAutomata(grammar[i]->getRegex()->getAutomata());
 		dAutomataVector.push_back(automata);
 		
 		// mark the final states of this automata to reconize this token
 		StateSet finalStates;
 		automata->getFinalStates(finalStates);
 		
-		for (StateSet::const_iterator it2 = finalStates.begin(); it2 != finalStates.end(); ++it2) {
-			stateToken[*it2] = g->getOrCreateTokenId((*it)->getTypeName());
+		for (StateSet::const_iterator it = finalStates.begin(); it != finalStates.end(); ++it) {
+			stateToken[*it] = tokenIds[i];
 		}
 	}
 	
@@ -51,10 +64,13 @@ ScannerAutomata *ScannerGrammar::compile(Grammar *g) const {
 	delete(resultAutomata);
 	
 	// setup the ignored tokens
-	for (TokenTypeList::const_iterator it = grammar.begin(); it != grammar.end(); ++it) {
-		if ((*it)->isIgnored()) {
-			scannerAutomata->addIgnoredToken(g->getOrCreateTokenId((*it)->getTypeName()));
-		}
+	for (unsigned int i = 0; i < grammar.size(); ++i) {
+		if (grammar[i]->isIgnored()) scannerAutomata->addIgnoredToken(tokenIds[i]);
+	}
+	
+	for (KeywordList::const_iterator it = keywords.begin(); it != keywords.end(); ++it) {
+		scannerAutomata->addKeyword(tokenIds[it->second.generic], it->second.literal,
+				tokenIds[it->first]);
 	}
 	
 	return scannerAutomata;
@@ -63,6 +79,73 @@ ScannerAutomata *ScannerGrammar::compile(Grammar *g) const {
 /*****************************************************************************
  * Auxiliar methods
  *****************************************************************************/
+void ScannerGrammar::findKeywords(const TokenIDList & tokenIds, KeywordList & keywords) const {
+	typedef std::map<std::string, unsigned int> LiteralCount;
+	
+	std::vector<std::string> literals(grammar.size());
+	LiteralCount literalCount;
+	
+	for (unsigned int i = 0; i < grammar.size(); ++i) {
+		if (grammar[i]->isIgnored()) continue;
+		if (getLiteral(grammar[i]->getRegex()->getAutomata(), literals[i])) ++literalCount[literals[i]];
+	}
+	
+	for (unsigned int i = 0; i < grammar.size(); ++i) {
+		// a single character costs only a transition in the automata,
+		// and two literal tokens with the same characters are left in it
+		if (literals[i].size() < 2 || literalCount[literals[i]] > 1) continue;
+		
+		// the token that would reconize the literal if it wasn't in the automata
+		int generic = -1;
+		for (unsigned int j = 0; j < grammar.size(); ++j) {
+			if (j == i || !grammar[j]->getRegex()->matches(literals[i])) continue;
+			if (generic == -1 || tokenIds[j] < tokenIds[generic]) generic = j;
+		}
+		
+		// the literal must have a higher priority than the generic token
+		if (generic == -1 || tokenIds[generic] <= tokenIds[i]) continue;
+		if (grammar[generic]->isIgnored()) continue;
+		
+		Keyword & keyword = keywords[i];
+		keyword.literal = literals[i];
+		keyword.generic = generic;
+	}
+}
+
+bool ScannerGrammar::getLiteral(const Automata *automata, std::string & literal) {
+	literal.clear();
+	
+	// follow the only transition of each state until a final state without transitions
+	unsigned int state = 0;
+	for (unsigned int i = 0; i < automata->getNumStates(); ++i) {
+		unsigned int numTransitions = 0;
+		int next = -1;
+		char input = '\0';
+		
+		for (unsigned int c = 0; c < ALPHABET_SIZE; ++c) {
+			int target = automata->getTransition(state, c);
+			if (target != -1) {
+				++numTransitions;
+				next = target;
+				input = c;
+			}
+		}
+		
+		if (automata->isFinalState(state)) {
+			if (numTransitions || literal.empty()) break;
+			return true;
+		}
+		
+		if (numTransitions != 1 || input == '\0') break;
+		
+		literal.push_back(input);
+		state = next;
+	}
+	
+	literal.clear();
+	return false;
+}
+
 ScannerAutomata *ScannerGrammar::convertAutomata(DynamicAutomata *dAutomata,
 		const StateToToken & stateToken) {
 	
@@ -94,8 +177,28 @@ void ScannerGrammar::minimizeAutomata(DynamicAutomata *automata, StateToToken &
 	automata->determinize(oldToNew, oldStates);
 	updateStateTokens(stateToken, oldToNew);
 	
+	// the final states that reconize the same token can be merged
+	std::map<TokenTypeID, StateSet> tokenStates;
+	StateSetList finalClasses;
+	
+	StateSet finalStates;
+	automata->getFinalStates(finalStates);
+	for (StateSet::const_iterator it = finalStates.begin(); it != finalStates.end(); ++it) {
+		StateToToken::const_iterator stateTokenIt = stateToken.find(*it);
+		if (stateTokenIt != stateToken.end()) tokenStates[stateTokenIt->second].insert(*it);
+		else {
+			finalClasses.push_back(StateSet());
+			finalClasses.back().insert(*it);
+		}
+	}
+	
+	for (std::map<TokenTypeID, StateSet>::const_iterator it = tokenStates.begin();
+			it != tokenStates.end(); ++it) {
+		finalClasses.push_back(it->second);
+	}
+	
 	StateToState mOldToNew;
-	automata->minimizeNoFinalMerge(mOldToNew, oldStates);
+	automata->minimize(mOldToNew, oldStates, finalClasses);
 	updateStateTokens(stateToken, mOldToNew);
 	
 	for (StateList::iterator it = oldStates.begin(); it != oldStates.end(); ++it) {
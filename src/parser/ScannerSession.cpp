@@ -0,0 +1,132 @@
+#include "parser/ScannerSession.h"
+
+#include "parser/InputLocation.h"
+#include "parser/ParserError.h"
+
+#include <cstring>
+
+ScannerSession::ScannerSession(const Pointer<ScannerAutomata> & a, const std::string & name) :
+		automata(a) {
+	
+	assert(automata);
+	
+	tokens.setInputName(name);
+	reset();
+	
+	tokens.setEndLocation(InputLocation(name, line, column));
+}
+
+void ScannerSession::reset() {
+	pending.clear();
+	state = 0;
+	reconizedToken = -1;
+	tokenLength = 0;
+	
+	inputPos = 0;
+	line = 1;
+	column = 0;
+	scanEnd = 0;
+}
+
+void ScannerSession::feed(const char *chars, unsigned int size) {
+	scan(chars, chars + size);
+}
+
+void ScannerSession::finish() {
+	// the end of the input stops the automata in the pending token
+	while (!pending.empty()) {
+		if (reconizedToken == -1) {
+			throw ParserError(InputLocation(tokens.getInputName(), line, column),
+					"Unexpected character \'\\0\'.");
+		}
+		
+		// the characters after the token are read again, the automata
+		// read the end of the input too
+		std::string rest = pending.substr(tokenLength);
+		addToken(pending.data(), tokenLength, pending.size() + 1);
+		scan(rest.data(), rest.data() + rest.size());
+	}
+	
+	tokens.setEndLocation(InputLocation(tokens.getInputName(), line, column));
+	reset();
+}
+
+TokenTable & ScannerSession::getTokens() {
+	return tokens;
+}
+
+unsigned int ScannerSession::getPendingChars() const {
+	return pending.size();
+}
+
+void ScannerSession::scan(const char *current, const char *end) {
+	while (current < end) {
+		const char *start = current;
+		const char *tokenEnd = NULL;
+		current = automata->walkAutomata(state, current, end, reconizedToken, tokenEnd);
+		if (tokenEnd) tokenLength = pending.size() + (tokenEnd - start);
+		
+		if (state != -1) {
+			// the token may continue in the next chunk
+			pending.append(start, current - start);
+			return;
+		}
+		
+		if (reconizedToken == -1) {
+			throw ParserError(InputLocation(tokens.getInputName(), line, column),
+					std::string("Unexpected character \'") + current[-1] + "\'.");
+		}
+		
+		unsigned int readChars = pending.size() + (current - start);
+		
+		if (tokenLength >= pending.size()) {
+			// the token ends in these characters
+			unsigned int used = tokenLength - pending.size();
+			
+			if (pending.empty()) addToken(start, used, readChars);
+			else {
+				pending.append(start, used);
+				addToken(pending.data(), tokenLength, readChars);
+			}
+			
+			current = start + used;
+		}
+		else {
+			// the token ended in a previous chunk, the characters after it are read again
+			std::string rest = pending.substr(tokenLength);
+			addToken(pending.data(), tokenLength, readChars);
+			scan(rest.data(), rest.data() + rest.size());
+			current = start;
+		}
+	}
+}
+
+void ScannerSession::addToken(const char *chars, unsigned int length, unsigned int readChars) {
+	assert(reconizedToken != -1 && length > 0);
+	
+	TokenTypeID id = automata->getKeywords().classify(reconizedToken, chars, length);
+	if (inputPos + readChars > scanEnd) scanEnd = inputPos + readChars;
+	
+	const ScannerAutomata::TokenTypeIDSet & ignored = automata->getIgnoredTokens();
+	if (ignored.find(id) == ignored.end()) {
+		tokens.addToken(id, inputPos, chars, length, line, column, scanEnd);
+		scanEnd = 0;
+	}
+	
+	// the location of the next token
+	inputPos += length;
+	
+	const char *end = chars + length;
+	const char *newLine;
+	while ((newLine = (const char *)memchr(chars, '\n', end - chars))) {
+		++line;
+		column = 0;
+		chars = newLine + 1;
+	}
+	column += end - chars;
+	
+	pending.clear();
+	state = 0;
+	reconizedToken = -1;
+	tokenLength = 0;
+}
@@ -0,0 +1,196 @@
+#include "parser/StreamInput.h"
+
+#include "parser/IOError.h"
+
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+#define BUFFER_SIZE 8192
+
+// when testing some times it's useful to reduce the size of the buffer
+//#define BUFFER_SIZE 64
+
+StreamInput::StreamInput(int fd) : fileDescriptor(fd), stream(NULL) {
+	init();
+}
+
+StreamInput::StreamInput(int fd, const std::string & name) : Input(name),
+		fileDescriptor(fd), stream(NULL) {
+	init();
+}
+
+StreamInput::StreamInput(std::istream & stream) : fileDescriptor(-1), stream(&stream) {
+	init();
+}
+
+StreamInput::StreamInput(std::istream & stream, const std::string & name) : Input(name),
+		fileDescriptor(-1), stream(&stream) {
+	init();
+}
+
+StreamInput::StreamInput(const std::string & name) : Input(name),
+		fileDescriptor(-1), stream(NULL) {
+	init();
+}
+
+StreamInput::~StreamInput() {
+	delete[](buffer);
+}
+
+void StreamInput::init() {
+	eof = false;
+	
+	buffer = new char[BUFFER_SIZE];
+	bufSize = BUFFER_SIZE;
+	
+	startPos = 0;
+	endPos = 0;
+	
+	setWindow();
+}
+
+bool StreamInput::fetchBuffer() {
+	assert(inputPos <= endPos);
+	
+	// keep the characters since the marked position, they are going to be
+	// read again if the scanner rollbacks
+	unsigned int keepPos = markedPos < inputPos ? markedPos : inputPos;
+	
+	if (inputPos == endPos && !fillBuffer(keepPos, true)) {
+		setWindow();
+		return false;
+	}
+	
+	setWindow();
+	return true;
+}
+
+bool StreamInput::fillBuffer(unsigned int keepPos, bool grow) {
+	if (eof) return false;
+	if (keepPos < startPos) keepPos = startPos;
+	
+	if (endPos - keepPos == bufSize) {
+		// the pending characters fill the buffer
+		if (!grow) return false;
+		
+		unsigned int newSize = bufSize * 2;
+		char *newBuffer = new char[newSize];
+		
+		for (unsigned int pos = keepPos; pos < endPos; ++pos)
+			newBuffer[pos % newSize] = buffer[pos % bufSize];
+		
+		delete[](buffer);
+		buffer = newBuffer;
+		bufSize = newSize;
+		startPos = keepPos;
+		discardLines(startPos);
+	}
+	
+	// read after endPos, until the end of the buffer or the first character to be kept
+	unsigned int offset = endPos % bufSize;
+	unsigned int size = bufSize - offset;
+	unsigned int free = bufSize - (endPos - keepPos);
+	if (size > free) size = free;
+	
+	// the positions are unsigned ints, nothing can be read after UINT_MAX
+	if (size > UINT_MAX - endPos) size = UINT_MAX - endPos;
+	if (!size) {
+		char c;
+		if (readStream(&c, 1)) throw IOError(inputName + " is larger than a StreamInput can read");
+		
+		eof = true;
+		return false;
+	}
+	
+	unsigned int read = readStream(buffer + offset, size);
+	if (!read) {
+		eof = true;
+		return false;
+	}
+	
+	endPos += read;
+	if (endPos - startPos > bufSize) {
+		startPos = endPos - bufSize;
+		discardLines(startPos);
+	}
+	
+	return true;
+}
+
+unsigned int StreamInput::readStream(char *buf, unsigned int size) {
+	if (stream) {
+		stream->read(buf, size);
+		if (stream->bad()) throw IOError(std::string("Cannot read ") + inputName);
+		return stream->gcount();
+	}
+	
+	ssize_t read;
+	do {
+		read = ::read(fileDescriptor, buf, size);
+	} while (read < 0 && errno == EINTR);
+	
+	if (read < 0) throw IOError(std::string("Cannot read ") + inputName);
+	return read;
+}
+
+void StreamInput::setWindow() {
+	unsigned int offset = inputPos % bufSize;
+	unsigned int size = endPos - inputPos;
+	if (size > bufSize - offset) size = bufSize - offset;
+	
+	bufferCurrent = buffer + offset;
+	bufferEnd = bufferCurrent + size;
+}
+
+void StreamInput::setInputPos(unsigned int pos) {
+	if (pos < startPos) throw IOError(std::string("Cannot go back in ") + inputName);
+	
+	// the lines read are counted before the buffer changes
+	seekLines(inputPos);
+	
+	// nothing before pos will be needed, discard everything while reading
+	while (pos > endPos && fillBuffer(endPos, false));
+	if (pos > endPos) pos = endPos;
+	
+	seekLines(pos);
+	inputPos = pos;
+	setWindow();
+}
+
+std::string StreamInput::getCurrentLine() {
+	unsigned int pos = getLineStart();
+	if (pos < startPos) pos = startPos;
+	unsigned int keepPos = markedPos < pos ? markedPos : pos;
+	
+	std::string line;
+	
+	// read the rest of the line while it fits in the buffer
+	do {
+		while (pos < endPos) {
+			const char *buf = buffer + pos % bufSize;
+			unsigned int size = endPos - pos;
+			if (size > bufSize - pos % bufSize) size = bufSize - pos % bufSize;
+			
+			const char *end = (const char *)memchr(buf, '\n', size);
+			if (end) return line.append(buf, end - buf);
+			
+			line.append(buf, size);
+			pos += size;
+		}
+	} while (fillBuffer(keepPos, false));
+	
+	return line;
+}
+
+void StreamInput::sanityCheck() const {
+	Input::sanityCheck();
+	
+	if (inputPos < startPos || inputPos > endPos) abort();
+	if (endPos - startPos > bufSize) abort();
+	if ((unsigned int)(bufferCurrent - buffer) % bufSize != inputPos % bufSize) abort();
+}
@@ -0,0 +1,68 @@
+#include "parser/TokenPool.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// the number of slots of an empty pool
+#define INITIAL_SLOTS 256
+
+TokenPool::TokenPool() : slots(INITIAL_SLOTS, NULL), hashes(INITIAL_SLOTS, 0) {}
+
+const std::string *TokenPool::intern(const char *chars, unsigned int length) {
+	unsigned int h = hash(chars, length);
+	unsigned int mask = slots.size() - 1;
+	
+	// linear probing, the hash is compared before the characters
+	unsigned int slot = h & mask;
+	for (; slots[slot]; slot = (slot + 1) & mask) {
+		const std::string *text = slots[slot];
+		if (hashes[slot] == h && text->size() == length && !memcmp(text->data(), chars, length))
+			return text;
+	}
+	
+	strings.push_back(std::string(chars, length));
+	slots[slot] = &strings.back();
+	hashes[slot] = h;
+	
+	const std::string *text = &strings.back();
+	if (strings.size() * 2 > slots.size()) grow();
+	
+	return text;
+}
+
+void TokenPool::grow() {
+	std::vector<const std::string *> oldSlots;
+	std::vector<unsigned int> oldHashes;
+	oldSlots.swap(slots);
+	oldHashes.swap(hashes);
+	
+	slots.assign(oldSlots.size() * 2, NULL);
+	hashes.assign(oldHashes.size() * 2, 0);
+	
+	unsigned int mask = slots.size() - 1;
+	for (unsigned int i = 0; i < oldSlots.size(); ++i) {
+		if (!oldSlots[i]) continue;
+		
+		unsigned int slot = oldHashes[i] & mask;
+		while (slots[slot]) slot = (slot + 1) & mask;
+		
+		slots[slot] = oldSlots[i];
+		hashes[slot] = oldHashes[i];
+	}
+}
+
+void TokenPool::sanityCheck() const {
+	if (slots.size() & (slots.size() - 1)) abort();
+	if (strings.size() * 2 > slots.size()) abort();
+	
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < slots.size(); ++i) {
+		if (!slots[i]) continue;
+		++count;
+		
+		const std::string & text = *slots[i];
+		if (hashes[i] != hash(text.data(), text.size())) abort();
+	}
+	
+	if (count != strings.size()) abort();
+}
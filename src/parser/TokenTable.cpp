@@ -0,0 +1,125 @@
+#include "parser/TokenTable.h"
+
+// replace count values starting at first by all the values of another vector
+template<class T>
+static void replaceValues(std::vector<T> & values, unsigned int first, unsigned int count,
+		const std::vector<T> & newValues) {
+	
+	values.erase(values.begin() + first, values.begin() + first + count);
+	values.insert(values.begin() + first, newValues.begin(), newValues.end());
+}
+
+TokenTable::TokenTable() : textPositions(1, 0) {}
+
+void TokenTable::clear() {
+	tokenTypeIds.clear();
+	inputPositions.clear();
+	
+	textPositions.clear();
+	textPositions.push_back(0);
+	text.clear();
+	
+	lines.clear();
+	columns.clear();
+	scanEnds.clear();
+	
+	endLocation = InputLocation(inputName);
+}
+
+std::string TokenTable::getToken(unsigned int index) const {
+	return std::string(getTokenChars(index), getLength(index));
+}
+
+InputLocation TokenTable::getInputLocation(unsigned int index) const {
+	return InputLocation(inputName, getLine(index), getColumn(index));
+}
+
+void TokenTable::setScanEnd(unsigned int index, unsigned int scanEnd) {
+	assert(index < size());
+	scanEnds[index] = scanEnd;
+}
+
+const std::vector<TokenTypeID> & TokenTable::getTokenTypeIds() const {
+	return tokenTypeIds;
+}
+
+const std::vector<unsigned int> & TokenTable::getInputPositions() const {
+	return inputPositions;
+}
+
+const std::string & TokenTable::getInputName() const {
+	return inputName;
+}
+
+void TokenTable::setInputName(const std::string & name) {
+	inputName = name;
+}
+
+const InputLocation & TokenTable::getEndLocation() const {
+	return endLocation;
+}
+
+void TokenTable::setEndLocation(const InputLocation & location) {
+	endLocation = location;
+}
+
+void TokenTable::addToken(TokenTypeID id, unsigned int pos, const char *chars, unsigned int length,
+		unsigned int line, unsigned int column, unsigned int scanEnd) {
+	
+	tokenTypeIds.push_back(id);
+	inputPositions.push_back(pos);
+	
+	text.append(chars, length);
+	textPositions.push_back(text.size());
+	
+	lines.push_back(line);
+	columns.push_back(column);
+	scanEnds.push_back(scanEnd);
+}
+
+void TokenTable::reserve(unsigned int numTokens, unsigned int numChars) {
+	tokenTypeIds.reserve(numTokens);
+	inputPositions.reserve(numTokens);
+	textPositions.reserve(numTokens + 1);
+	text.reserve(numChars);
+	lines.reserve(numTokens);
+	columns.reserve(numTokens);
+	scanEnds.reserve(numTokens);
+}
+
+void TokenTable::replaceTokens(unsigned int first, unsigned int count, const TokenTable & tokens) {
+	assert(first + count <= size());
+	
+	replaceValues(tokenTypeIds, first, count, tokens.tokenTypeIds);
+	replaceValues(inputPositions, first, count, tokens.inputPositions);
+	replaceValues(lines, first, count, tokens.lines);
+	replaceValues(columns, first, count, tokens.columns);
+	replaceValues(scanEnds, first, count, tokens.scanEnds);
+	
+	// replace the characters, the tokens after them are moved in the text
+	unsigned int textStart = textPositions[first];
+	unsigned int textEnd = textPositions[first + count];
+	text.replace(textStart, textEnd - textStart, tokens.text);
+	
+	int textOffset = (int)tokens.text.size() - (int)(textEnd - textStart);
+	for (unsigned int i = first + count + 1; i < textPositions.size(); ++i)
+		textPositions[i] += textOffset;
+	
+	std::vector<unsigned int> ends;
+	for (unsigned int i = 1; i < tokens.textPositions.size(); ++i)
+		ends.push_back(textStart + tokens.textPositions[i]);
+	replaceValues(textPositions, first + 1, count, ends);
+}
+
+void TokenTable::moveTokens(unsigned int first, int posOffset, unsigned int line, int lineOffset,
+		int columnOffset) {
+	
+	for (unsigned int i = first; i < size(); ++i) {
+		inputPositions[i] += posOffset;
+		
+		if (lines[i] == line) columns[i] += columnOffset;
+		lines[i] += lineOffset;
+		
+		if (scanEnds[i] != UINT_MAX) scanEnds[i] += posOffset;
+	}
+}
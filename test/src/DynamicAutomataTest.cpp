@@ -257,3 +257,60 @@ void DynamicAutomataTest::minimizeStateMappingTest() {
 		delete(*it);
 	}
 }
+
+void DynamicAutomataTest::minimizeFinalClassesTest() {
+	// x\d*, y\d* and z\d*, the first two are the same token
+	DynamicAutomata *automata = new DynamicAutomata();
+	
+	DynamicAutomata::State *s = automata->getInitialState();
+	DynamicAutomata::State *x = automata->createState();
+	DynamicAutomata::State *y = automata->createState();
+	DynamicAutomata::State *z = automata->createState();
+	
+	s->addTransition('x', x);
+	s->addTransition('y', y);
+	s->addTransition('z', z);
+	
+	for (char c = '0'; c <= '9'; ++c) {
+		x->addTransition(c, x);
+		y->addTransition(c, y);
+		z->addTransition(c, z);
+	}
+	
+	x->setFinalState(true);
+	y->setFinalState(true);
+	z->setFinalState(true);
+	
+	DynamicAutomata *noFinalMerge = automata->clone();
+	noFinalMerge->minimizeNoFinalMerge();
+	CPPUNIT_ASSERT(noFinalMerge->getNumStates() == 4);
+	
+	DynamicAutomata *finalMerge = automata->clone();
+	finalMerge->minimize();
+	CPPUNIT_ASSERT(finalMerge->getNumStates() == 2);
+	
+	DynamicAutomata::StateSetList finalClasses(2);
+	finalClasses[0].insert(x);
+	finalClasses[0].insert(y);
+	finalClasses[1].insert(z);
+	
+	DynamicAutomata::StateToState oldToNew;
+	DynamicAutomata::StateList oldStates;
+	automata->minimize(oldToNew, oldStates, finalClasses);
+	
+	CPPUNIT_ASSERT(automata->getNumStates() == 3);
+	CPPUNIT_ASSERT(oldStates.size() == 1);
+	CPPUNIT_ASSERT(oldToNew[x] == oldToNew[y]);
+	CPPUNIT_ASSERT(oldToNew[x] != oldToNew[z]);
+	CPPUNIT_ASSERT(oldToNew[s] == automata->getInitialState());
+	CPPUNIT_ASSERT(automata->getInitialState()->getTransition('y') == oldToNew[x]);
+	CPPUNIT_ASSERT(oldToNew[x]->getTransition('5') == oldToNew[x]);
+	
+	for (DynamicAutomata::StateList::iterator it = oldStates.begin(); it != oldStates.end(); ++it) {
+		delete(*it);
+	}
+	
+	delete(noFinalMerge);
+	delete(finalMerge);
+	delete(automata);
+}
@@ -12,6 +12,7 @@ class DynamicAutomataTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST(conversionTest);
 	CPPUNIT_TEST(conversionTest2);
 	CPPUNIT_TEST(minimizeStateMappingTest);
+	CPPUNIT_TEST(minimizeFinalClassesTest);
 	CPPUNIT_TEST_SUITE_END();
 	
 	public:
@@ -26,6 +27,7 @@ class DynamicAutomataTest : public CppUnit::TestFixture {
 		void conversionTest2();
 		
 		void minimizeStateMappingTest();
+		void minimizeFinalClassesTest();
 };
 
 #endif
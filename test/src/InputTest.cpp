@@ -3,14 +3,30 @@
 #include "TestDefs.h"
 
 #include "parser/FileInput.h"
+#include "parser/ListInput.h"
 #include "parser/MemoryInput.h"
+#include "parser/MmapInput.h"
+#include "parser/OffsetInput.h"
+#include "parser/StreamInput.h"
+
+#ifdef PARSER_HAVE_ZLIB
+#include "parser/GzipInput.h"
+#endif
 
 #include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(InputTest);
 
 static std::string readFile(const std::string & file);
 static std::string createInput(unsigned int size);
+#ifdef PARSER_HAVE_ZLIB
+static std::string writeGzipFile(const std::string & input);
+#endif
 
 void InputTest::setUp() {}
 
@@ -23,6 +39,10 @@ void InputTest::test1() {
 	doTest(fileInput, input);
 	delete(fileInput);
 	
+	Input *mmapInput = new MmapInput(INPUT_FOLDER + "input1.txt");
+	doTest(mmapInput, input);
+	delete(mmapInput);
+	
 	Input *memoryInput = new MemoryInput(input.c_str());
 	doTest(memoryInput, input);
 	delete(memoryInput);
@@ -35,6 +55,10 @@ void InputTest::test2() {
 	doTest(fileInput, input);
 	delete(fileInput);
 	
+	Input *mmapInput = new MmapInput(INPUT_FOLDER + "input2.txt");
+	doTest(mmapInput, input);
+	delete(mmapInput);
+	
 	Input *memoryInput = new MemoryInput(input.c_str());
 	doTest(memoryInput, input);
 	delete(memoryInput);
@@ -60,6 +84,177 @@ void InputTest::dynamicTest5() {
 	doDynamicTest(100);
 }
 
+void InputTest::bufferTest() {
+	std::string input1 = readFile(INPUT_FOLDER + "input1.txt");
+	std::string input2 = readFile(INPUT_FOLDER + "input2.txt");
+	
+	Input *fileInput = new FileInput(INPUT_FOLDER + "input1.txt");
+	doBufferTest(fileInput, input1);
+	delete(fileInput);
+	
+	Input *memoryInput = new MemoryInput(input1);
+	doBufferTest(memoryInput, input1);
+	delete(memoryInput);
+	
+	Input *mmapInput = new MmapInput(INPUT_FOLDER + "input1.txt");
+	doBufferTest(mmapInput, input1);
+	delete(mmapInput);
+	
+	Input *offsetInput = new OffsetInput(new FileInput(INPUT_FOLDER + "input2.txt"), 10);
+	doBufferTest(offsetInput, input2);
+	delete(offsetInput);
+	
+	// the lines of a ListInput are counted for each input, so use only one line
+	std::string line = "int main(int argc, char *argv[]) { return 0; }";
+	ListInput *listInput = new ListInput();
+	listInput->addInput(new MemoryInput(line.substr(0, 9)));
+	listInput->addInput(new MemoryInput(line.substr(9)));
+	doBufferTest(listInput, line);
+	delete(listInput);
+}
+
+void InputTest::rollbackTest() {
+	// bigger than the FileInput buffer
+	unsigned int size = 20000;
+	std::string input = createInput(size);
+	
+	char *buf = new char[size + 1];
+	for (unsigned int i = 0; i < size; ++i) buf[i] = input[i];
+	buf[size] = '\0';
+	
+	FILE *fp = fmemopen(buf, size, "r");
+	
+	Input *fileInput = new FileInput(fp);
+	doRollbackTest(fileInput, input);
+	delete(fileInput);
+	delete[](buf);
+	
+	Input *memoryInput = new MemoryInput(input);
+	doRollbackTest(memoryInput, input);
+	delete(memoryInput);
+}
+
+void InputTest::streamTest() {
+	std::string input1 = readFile(INPUT_FOLDER + "input1.txt");
+	
+	std::istringstream stream1(input1);
+	Input *streamInput = new StreamInput(stream1);
+	doBufferTest(streamInput, input1);
+	delete(streamInput);
+	
+	// bigger than the StreamInput buffer
+	unsigned int size = 20000;
+	std::string input = createInput(size);
+	
+	// the whole input fits in the pipe
+	int fds[2];
+	CPPUNIT_ASSERT(pipe(fds) == 0);
+	CPPUNIT_ASSERT(write(fds[1], input.c_str(), size) == (int)size);
+	close(fds[1]);
+	
+	streamInput = new StreamInput(fds[0]);
+	doRollbackTest(streamInput, input);
+	delete(streamInput);
+	close(fds[0]);
+	
+	// a token bigger than the buffer
+	std::istringstream stream2(input);
+	streamInput = new StreamInput(stream2);
+	streamInput->markPosition();
+	for (unsigned int i = 0; i < size; ++i) CPPUNIT_ASSERT(streamInput->nextChar() == input[i]);
+	
+	streamInput->rollback(size / 2);
+	streamInput->sanityCheck();
+	for (unsigned int i = size / 2; i < size; ++i) CPPUNIT_ASSERT(streamInput->nextChar() == input[i]);
+	CPPUNIT_ASSERT(streamInput->nextChar() == '\0');
+	delete(streamInput);
+}
+
+void InputTest::lineTest() {
+	std::string input = readFile(INPUT_FOLDER + "input_c1.txt");
+	
+	Input *fileInput = new FileInput(INPUT_FOLDER + "input_c1.txt");
+	doLineTest(fileInput, input);
+	delete(fileInput);
+	
+	Input *memoryInput = new MemoryInput(input);
+	doLineTest(memoryInput, input);
+	delete(memoryInput);
+	
+	Input *mmapInput = new MmapInput(INPUT_FOLDER + "input_c1.txt");
+	doLineTest(mmapInput, input);
+	delete(mmapInput);
+	
+	std::istringstream stream(input);
+	Input *streamInput = new StreamInput(stream);
+	doLineTest(streamInput, input);
+	delete(streamInput);
+	
+	// larger than the buffers, so the windows change between the lines asked
+	std::string large;
+	for (unsigned int i = 0; large.size() < 40000; ++i) {
+		large += input.substr(0, i * 7 % input.size());
+		large.push_back('\n');
+	}
+	
+	memoryInput = new MemoryInput(large);
+	doBufferLineTest(memoryInput, large);
+	delete(memoryInput);
+	
+	std::istringstream largeStream(large);
+	streamInput = new StreamInput(largeStream);
+	doBufferLineTest(streamInput, large);
+	delete(streamInput);
+}
+
+void InputTest::readAheadTest() {
+	std::string input1 = readFile(INPUT_FOLDER + "input_c1.txt");
+	
+	FileInput *fileInput = new FileInput(INPUT_FOLDER + "input_c1.txt");
+	fileInput->setReadAhead(64, 4);
+	doLineTest(fileInput, input1);
+	delete(fileInput);
+	
+	// bigger than the blocks
+	unsigned int size = 20000;
+	std::string input = createInput(size);
+	
+	FILE *fp = tmpfile();
+	CPPUNIT_ASSERT(fp);
+	CPPUNIT_ASSERT(fwrite(input.c_str(), sizeof(char), size, fp) == size);
+	rewind(fp);
+	
+	fileInput = new FileInput(fp);
+	fileInput->setReadAhead(1024, 4);
+	doRollbackTest(fileInput, input);
+	delete(fileInput);
+}
+
+#ifdef PARSER_HAVE_ZLIB
+void InputTest::gzipTest() {
+	// files that are not compressed are read as they are
+	std::string input1 = readFile(INPUT_FOLDER + "input1.txt");
+	Input *gzipInput = new GzipInput(INPUT_FOLDER + "input1.txt");
+	doBufferTest(gzipInput, input1);
+	delete(gzipInput);
+	
+	std::string inputC = readFile(INPUT_FOLDER + "input_c1.txt");
+	std::string fileC = writeGzipFile(inputC);
+	gzipInput = new GzipInput(fileC);
+	doLineTest(gzipInput, inputC);
+	delete(gzipInput);
+	unlink(fileC.c_str());
+	
+	// bigger than the StreamInput buffer
+	std::string input = createInput(20000);
+	std::string file = writeGzipFile(input);
+	gzipInput = new GzipInput(file);
+	doRollbackTest(gzipInput, input);
+	delete(gzipInput);
+	unlink(file.c_str());
+}
+#endif
+
 void InputTest::doDynamicTest(unsigned int size) {
 	std::string input = createInput(size);
 	
@@ -116,6 +311,156 @@ void InputTest::doTest(Input *input, const std::string & inputBuf) {
 	}
 }
 
+void InputTest::doBufferTest(Input *input, const std::string & inputBuf) {
+	input->sanityCheck();
+	
+	unsigned int line = input->getInputLine();
+	unsigned int pos = 0;
+	
+	const char *buf;
+	unsigned int size;
+	while ((size = input->getBuffer(buf))) {
+		CPPUNIT_ASSERT(pos + size <= inputBuf.size());
+		
+		// consume the buffer in two steps
+		unsigned int half = size / 2;
+		for (unsigned int i = 0; i < size; ++i) {
+			CPPUNIT_ASSERT(buf[i] == inputBuf[pos + i]);
+			if (buf[i] == '\n') ++line;
+			
+			if (i + 1 == half) {
+				input->consumeBuffer(half);
+				input->sanityCheck();
+			}
+		}
+		input->consumeBuffer(size - half);
+		input->sanityCheck();
+		
+		pos += size;
+		CPPUNIT_ASSERT(input->getInputLine() == line);
+	}
+	
+	CPPUNIT_ASSERT(pos == inputBuf.size());
+	CPPUNIT_ASSERT(input->nextChar() == '\0');
+}
+
+void InputTest::doRollbackTest(Input *input, const std::string & inputBuf) {
+	// read like the scanner does, reading some characters after each token
+	unsigned int pos = 0;
+	unsigned int tokenSize = 1;
+	
+	while (pos < inputBuf.size()) {
+		if (pos + tokenSize > inputBuf.size()) tokenSize = inputBuf.size() - pos;
+		
+		input->markPosition();
+		
+		unsigned int read = tokenSize + 3;
+		for (unsigned int i = 0; i < read; ++i) {
+			char c = pos + i < inputBuf.size() ? inputBuf[pos + i] : '\0';
+			CPPUNIT_ASSERT(input->nextChar() == c);
+		}
+		
+		input->rollback(tokenSize);
+		input->sanityCheck();
+		
+		pos += tokenSize;
+		CPPUNIT_ASSERT(input->getInputPos() == pos);
+		
+		tokenSize = tokenSize % 97 + 1;
+	}
+	
+	CPPUNIT_ASSERT(input->nextChar() == '\0');
+}
+
+void InputTest::doLineTest(Input *input, const std::string & inputBuf) {
+	// the line and column of each position
+	std::vector<unsigned int> lines;
+	std::vector<unsigned int> columns;
+	
+	unsigned int line = 1;
+	unsigned int column = 0;
+	for (unsigned int i = 0; i <= inputBuf.size(); ++i) {
+		lines.push_back(line);
+		columns.push_back(column);
+		
+		if (i < inputBuf.size() && inputBuf[i] == '\n') {
+			++line;
+			column = 0;
+		}
+		else ++column;
+	}
+	
+	// read some characters after each step and rollback
+	unsigned int pos = 0;
+	unsigned int step = 1;
+	
+	while (pos < inputBuf.size()) {
+		input->markPosition();
+		
+		unsigned int read = step + 5;
+		if (pos + read > inputBuf.size()) read = inputBuf.size() - pos;
+		for (unsigned int i = 0; i < read; ++i) input->nextChar();
+		
+		CPPUNIT_ASSERT(input->getInputLine() == lines[pos + read]);
+		CPPUNIT_ASSERT(input->getCurrentLinePos() == columns[pos + read]);
+		
+		if (step > read) step = read;
+		input->rollback(step);
+		input->sanityCheck();
+		pos += step;
+		
+		CPPUNIT_ASSERT(input->getInputPos() == pos);
+		CPPUNIT_ASSERT(input->getInputLine() == lines[pos]);
+		CPPUNIT_ASSERT(input->getCurrentLinePos() == columns[pos]);
+		
+		unsigned int lineStart = pos - columns[pos];
+		std::string::size_type lineEnd = inputBuf.find('\n', lineStart);
+		if (lineEnd == std::string::npos) lineEnd = inputBuf.size();
+		CPPUNIT_ASSERT(input->getCurrentLine() == inputBuf.substr(lineStart, lineEnd - lineStart));
+		CPPUNIT_ASSERT(input->getInputPos() == pos);
+		
+		step = step % 13 + 1;
+	}
+}
+
+void InputTest::doBufferLineTest(Input *input, const std::string & inputBuf) {
+	// read the buffer in chunks, asking the line only after some of them,
+	// with nothing to rollback the windows are replaced
+	unsigned int pos = 0;
+	unsigned int step = 1;
+	unsigned int line = 1;
+	unsigned int lineStart = 0;
+	
+	const char *buf;
+	unsigned int size;
+	while ((size = input->getBuffer(buf))) {
+		input->markPosition();
+		
+		unsigned int read = step * 89;
+		if (read > size) read = size;
+		input->consumeBuffer(read);
+		
+		for (unsigned int i = pos; i < pos + read; ++i) {
+			if (inputBuf[i] == '\n') {
+				++line;
+				lineStart = i + 1;
+			}
+		}
+		pos += read;
+		
+		if (step % 6 == 0) {
+			CPPUNIT_ASSERT(input->getInputLine() == line);
+			CPPUNIT_ASSERT(input->getCurrentLinePos() == pos - lineStart);
+		}
+		
+		step = step % 13 + 1;
+	}
+	
+	CPPUNIT_ASSERT(pos == inputBuf.size());
+	CPPUNIT_ASSERT(input->getInputLine() == line);
+	CPPUNIT_ASSERT(input->getCurrentLinePos() == pos - lineStart);
+}
+
 static std::string readFile(const std::string & file) {
 	std::string in;
 	
@@ -129,6 +474,20 @@ static std::string readFile(const std::string & file) {
 	return in;
 }
 
+#ifdef PARSER_HAVE_ZLIB
+static std::string writeGzipFile(const std::string & input) {
+	char file[] = "/tmp/input_test_XXXXXX";
+	int fd = mkstemp(file);
+	CPPUNIT_ASSERT(fd >= 0);
+	
+	gzFile gz = gzdopen(fd, "wb");
+	CPPUNIT_ASSERT(gzwrite(gz, input.c_str(), input.size()) == (int)input.size());
+	gzclose(gz);
+	
+	return file;
+}
+#endif
+
 static std::string createInput(unsigned int size) {
 	std::string in;
 	
@@ -20,6 +20,15 @@ class InputTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST(dynamicTest4);
 	CPPUNIT_TEST(dynamicTest5);
 	
+	CPPUNIT_TEST(bufferTest);
+	CPPUNIT_TEST(rollbackTest);
+	CPPUNIT_TEST(streamTest);
+	CPPUNIT_TEST(lineTest);
+	CPPUNIT_TEST(readAheadTest);
+#ifdef PARSER_HAVE_ZLIB
+	CPPUNIT_TEST(gzipTest);
+#endif
+	
 	CPPUNIT_TEST_SUITE_END();
 	
 	public:
@@ -35,9 +44,22 @@ class InputTest : public CppUnit::TestFixture {
 		void dynamicTest4();
 		void dynamicTest5();
 		
+		void bufferTest();
+		void rollbackTest();
+		void streamTest();
+		void lineTest();
+		void readAheadTest();
+#ifdef PARSER_HAVE_ZLIB
+		void gzipTest();
+#endif
+		
 	private:
 		void doDynamicTest(unsigned int size);
 		void doTest(Input *input, const std::string & inputBuf);
+		void doBufferTest(Input *input, const std::string & inputBuf);
+		void doRollbackTest(Input *input, const std::string & inputBuf);
+		void doLineTest(Input *input, const std::string & inputBuf);
+		void doBufferLineTest(Input *input, const std::string & inputBuf);
 };
 
 #endif
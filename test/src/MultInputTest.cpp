@@ -7,6 +7,8 @@
 #include "parser/MemoryInput.h"
 #include "parser/OffsetInput.h"
 
+#include <vector>
+
 CPPUNIT_TEST_SUITE_REGISTRATION(MultInputTest);
 
 static std::string readFile(const std::string & file);
@@ -65,6 +67,68 @@ void MultInputTest::listInputTest2() {
 	delete(listInput);
 }
 
+void MultInputTest::listRollbackTest() {
+	std::string inputBuf = readFile(INPUT_FOLDER + "input_c1.txt");
+	
+	// split the input in small chunks, the line and column are counted for each chunk
+	std::vector<unsigned int> lines;
+	std::vector<unsigned int> columns;
+	
+	ListInput *listInput = new ListInput();
+	
+	unsigned int chunkSize = 1;
+	for (unsigned int start = 0; start < inputBuf.size(); start += chunkSize) {
+		chunkSize = chunkSize % 9 + 1;
+		if (start + chunkSize > inputBuf.size()) chunkSize = inputBuf.size() - start;
+		
+		listInput->addInput(new MemoryInput(inputBuf.substr(start, chunkSize)));
+		
+		unsigned int line = 1;
+		unsigned int column = 0;
+		for (unsigned int i = start; i < start + chunkSize; ++i) {
+			lines.push_back(line);
+			columns.push_back(column);
+			
+			if (inputBuf[i] == '\n') {
+				++line;
+				column = 0;
+			}
+			else ++column;
+		}
+	}
+	
+	// read like the scanner does, the rollbacks go back to the previous chunks
+	unsigned int pos = 0;
+	unsigned int tokenSize = 1;
+	
+	while (pos < inputBuf.size()) {
+		if (pos + tokenSize > inputBuf.size()) tokenSize = inputBuf.size() - pos;
+		
+		listInput->markPosition();
+		
+		unsigned int read = tokenSize + 11;
+		for (unsigned int i = 0; i < read; ++i) {
+			char c = pos + i < inputBuf.size() ? inputBuf[pos + i] : '\0';
+			CPPUNIT_ASSERT(listInput->nextChar() == c);
+		}
+		
+		listInput->rollback(tokenSize);
+		listInput->sanityCheck();
+		
+		pos += tokenSize;
+		if (pos < inputBuf.size()) {
+			CPPUNIT_ASSERT(listInput->getInputLine() == lines[pos]);
+			CPPUNIT_ASSERT(listInput->getCurrentLinePos() == columns[pos]);
+		}
+		
+		tokenSize = tokenSize % 7 + 1;
+	}
+	
+	CPPUNIT_ASSERT(listInput->nextChar() == '\0');
+	
+	delete(listInput);
+}
+
 void MultInputTest::offsetInputTest1() {
 	const unsigned int TESTS = 5;
 	
@@ -13,6 +13,7 @@ class MultInputTest : public CppUnit::TestFixture {
 	
 	CPPUNIT_TEST(listInputTest1);
 	CPPUNIT_TEST(listInputTest2);
+	CPPUNIT_TEST(listRollbackTest);
 	
 	CPPUNIT_TEST(offsetInputTest1);
 	CPPUNIT_TEST(offsetInputTest2);
@@ -25,6 +26,7 @@ class MultInputTest : public CppUnit::TestFixture {
 		
 		void listInputTest1();
 		void listInputTest2();
+		void listRollbackTest();
 		
 		void offsetInputTest1();
 		void offsetInputTest2();
@@ -2,6 +2,7 @@
 
 #include "TestDefs.h"
 
+#include "parser/Automata.h"
 #include "parser/Grammar.h"
 #include "parser/GrammarLoader.h"
 #include "parser/ParserGrammar.h"
@@ -9,11 +10,13 @@
 #include "parser/ParserTable.h"
 #include "parser/ParserTableLL1.h"
 #include "parser/ParserTableSLR1.h"
+#include "parser/ParserDefs.h"
 #include "parser/Regex.h"
 #include "parser/ScannerAutomata.h"
 #include "parser/ScannerGrammar.h"
 
 #include <cstring>
+#include <stdint.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ParserLoaderTest);
 
@@ -33,6 +36,95 @@ void ParserLoaderTest::test2() {
 				GRAMMAR_FOLDER + "parser2.bnf"));
 }
 
+void ParserLoaderTest::oldAutomataTest() {
+	// an automata that accepts "ab" saved in the format with one row for
+	// each of the 128 ASCii characters
+	const unsigned int numStates = 3;
+	uint32_t buf[1 + 128 * numStates + 1 + numStates + 1];
+	unsigned int pos = 0;
+	
+	buf[pos++] = numStates;
+	for (unsigned int input = 0; input < 128; ++input) {
+		for (unsigned int state = 0; state < numStates; ++state) {
+			int target = -1;
+			if (input == 'a' && state == 0) target = 1;
+			if (input == 'b' && state == 1) target = 2;
+			buf[pos++] = (uint32_t)target;
+		}
+	}
+	buf[pos++] = 1 << 2; // finalStates
+	buf[pos++] = (uint32_t)-1; // stateTokenTypeId
+	buf[pos++] = (uint32_t)-1;
+	buf[pos++] = 0;
+	buf[pos++] = 0; // numIgnoredTokens
+	
+	ScannerAutomata *scannerAutomata = ParserLoader::bufferToAutomata((const unsigned char *)buf);
+	Automata *automata = scannerAutomata->getAutomata();
+	
+	CPPUNIT_ASSERT(automata->getNumStates() == numStates);
+	CPPUNIT_ASSERT(automata->getNumClasses() == 3);
+	CPPUNIT_ASSERT(automata->accept("ab"));
+	CPPUNIT_ASSERT(!automata->accept("a"));
+	CPPUNIT_ASSERT(!automata->accept("a\xe1"));
+	CPPUNIT_ASSERT(scannerAutomata->getStateTokenTypeId(2) == 0);
+	
+	for (unsigned int input = 128; input < ALPHABET_SIZE; ++input) {
+		CPPUNIT_ASSERT(automata->getTransition(0, input) == -1);
+	}
+	
+	// saved again in the current format
+	unsigned int size;
+	unsigned char *newBuf = ParserLoader::automataToBuffer(scannerAutomata, &size);
+	ScannerAutomata *newAutomata = ParserLoader::bufferToAutomata(newBuf);
+	
+	CPPUNIT_ASSERT(*newAutomata->getAutomata() == *automata);
+	
+	delete[](newBuf);
+	delete(newAutomata);
+	delete(scannerAutomata);
+}
+
+void ParserLoaderTest::wideAutomataTest() {
+	// a chain of states that needs 16 bits entries, with a token id that needs 32 bits
+	const unsigned int numStates = 300;
+	Automata *automata = new Automata(numStates);
+	
+	CPPUNIT_ASSERT(automata->getEntrySize() == 2);
+	
+	for (unsigned int i = 0; i + 1 < numStates; ++i) {
+		automata->setTransition(i, 'a' + i % 3, i + 1);
+	}
+	automata->setFinalState(numStates - 1);
+	automata->compressAlphabet();
+	
+	ScannerAutomata *scannerAutomata = new ScannerAutomata(automata);
+	scannerAutomata->setStateTokenTypeId(numStates - 1, 100000);
+	
+	CPPUNIT_ASSERT(automata->getEntrySize() == 4);
+	CPPUNIT_ASSERT(automata->getNumClasses() == 4);
+	CPPUNIT_ASSERT((size_t)automata->getTransitionTable() % 64 == 0);
+	CPPUNIT_ASSERT(automata->getRowSize() > automata->getNumClasses());
+	
+	std::string sentence;
+	for (unsigned int i = 0; i + 1 < numStates; ++i) sentence += 'a' + i % 3;
+	CPPUNIT_ASSERT(automata->accept(sentence.c_str()));
+	
+	testAutomata(scannerAutomata);
+	
+	unsigned int size;
+	unsigned char *buf = ParserLoader::automataToBuffer(scannerAutomata, &size);
+	ScannerAutomata *bufAutomata = ParserLoader::bufferToAutomata(buf);
+	
+	CPPUNIT_ASSERT(bufAutomata->getAutomata()->getEntrySize() == 4);
+	CPPUNIT_ASSERT(bufAutomata->getStateTokenTypeId(numStates - 1) == 100000);
+	CPPUNIT_ASSERT(bufAutomata->getStateTokenTypeId(0) == -1);
+	CPPUNIT_ASSERT(bufAutomata->getAutomata()->accept(sentence.c_str()));
+	
+	delete[](buf);
+	delete(bufAutomata);
+	delete(scannerAutomata);
+}
+
 void ParserLoaderTest::testGrammar(ParserType type, Grammar *grammar) {
 	ParserGrammar *parserGrammar = grammar->getParserGrammar();
 	
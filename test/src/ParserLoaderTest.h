@@ -14,6 +14,9 @@ class ParserLoaderTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST(test1);
 	CPPUNIT_TEST(test2);
 	
+	CPPUNIT_TEST(oldAutomataTest);
+	CPPUNIT_TEST(wideAutomataTest);
+	
 	CPPUNIT_TEST_SUITE_END();
 	
 	public:
@@ -23,6 +26,9 @@ class ParserLoaderTest : public CppUnit::TestFixture {
 		void test1();
 		void test2();
 		
+		void oldAutomataTest();
+		void wideAutomataTest();
+		
 	protected:
 		enum ParserType {
 			LL1,
@@ -5,6 +5,7 @@
 #include "parser/FileInput.h"
 #include "parser/Grammar.h"
 #include "parser/GrammarLoader.h"
+#include "parser/MemoryInput.h"
 #include "parser/Parser.h"
 #include "parser/ParserCompileResult.h"
 #include "parser/ParserGrammar.h"
@@ -12,14 +13,50 @@
 #include "parser/ParserTableLL1.h"
 #include "parser/ParserTableSLR1.h"
 #include "parser/ParsingTree.h"
+#include "parser/Regex.h"
 #include "parser/Scanner.h"
 #include "parser/ScannerAutomata.h"
 #include "parser/ScannerGrammar.h"
+#include "parser/TokenTable.h"
 
 #include <cstdlib>
+#include <pthread.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ParserTest);
 
+// a thread parsing with a table and an automata shared by all the threads
+struct ParserThread {
+	Pointer<ParserTable> table;
+	Pointer<ScannerAutomata> automata;
+	ParsingTree::NonTerminalID startId;
+	
+	unsigned int parsed;
+	unsigned int matched;
+};
+
+static void *parserThread(void *arg) {
+	ParserThread *thread = (ParserThread *)arg;
+	
+	for (unsigned int i = 0; i < 50; ++i) {
+		Parser parser(thread->table, new Scanner(thread->automata,
+				new FileInput(INPUT_FOLDER + "input_parser2.txt")));
+		
+		ParsingTree::Node *node = parser.parse();
+		if (node && node->getNodeType() == ParsingTree::NODE_NON_TERMINAL &&
+				((ParsingTree::NonTerminal *)node)->getNonTerminalId() == thread->startId) {
+			++thread->parsed;
+		}
+		delete(node);
+		
+		// the regexes share the compiler and its cache
+		Regex regex("<\\w+>");
+		Regex::Match match;
+		if (regex.search("<START> ::= <FOO>", match, 1) && match.position == 12) ++thread->matched;
+	}
+	
+	return NULL;
+}
+
 void ParserTest::setUp() {}
 
 void ParserTest::tearDown() {}
@@ -64,6 +101,82 @@ void ParserTest::slr1Test2() {
 	delete(parser);
 }
 
+void ParserTest::tokenTableTest() {
+	ParserType types[] = {LL1, SLR1};
+	
+	for (unsigned int i = 0; i < 2; ++i) {
+		Grammar *grammar;
+		Parser *parser = loadParser(types[i], &grammar, "scanner2.bnf", "parser2.bnf", "input_parser2.txt");
+		
+		TokenTable tokens;
+		FileInput input(INPUT_FOLDER + "input_parser2.txt");
+		parser->getScanner()->tokenizeAll(&input, tokens);
+		
+		testParser2(parser, grammar, &tokens);
+		
+		// the table can be parsed again
+		testParser2(parser, grammar, &tokens);
+		
+		// the error at the end of the tokens is at the end of the input
+		MemoryInput truncated("<START> ::= <FOO>", "truncated");
+		parser->getScanner()->tokenizeAll(&truncated, tokens);
+		
+		Parser::ParserErrorList errorList;
+		CPPUNIT_ASSERT(!parser->parseWithErrorRecovery(tokens, errorList));
+		CPPUNIT_ASSERT(!errorList.empty());
+		CPPUNIT_ASSERT(errorList.back().getInputName() == "truncated");
+		CPPUNIT_ASSERT(errorList.back().getLineNumber() == tokens.getEndLocation().getLine());
+		
+		delete(grammar->getScannerGrammar());
+		delete(grammar->getParserGrammar());
+		delete(grammar);
+		delete(parser);
+	}
+}
+
+void ParserTest::threadTest() {
+	Grammar *grammar;
+	Parser *parser = loadParser(SLR1, &grammar, "scanner2.bnf", "parser2.bnf", "input_parser2.txt");
+	
+	Pointer<ParserTable> table = parser->getParserTable();
+	Pointer<ScannerAutomata> automata = parser->getScanner()->getScannerAutomata();
+	int tableReferences = table.getReferences();
+	int automataReferences = automata.getReferences();
+	
+	const unsigned int numThreads = 4;
+	ParserThread threads[numThreads];
+	pthread_t ids[numThreads];
+	
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		threads[i].table = table;
+		threads[i].automata = automata;
+		threads[i].startId = grammar->getNonTerminalId("PARSER");
+		threads[i].parsed = 0;
+		threads[i].matched = 0;
+		
+		CPPUNIT_ASSERT(!pthread_create(&ids[i], NULL, parserThread, &threads[i]));
+	}
+	
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		pthread_join(ids[i], NULL);
+		
+		CPPUNIT_ASSERT(threads[i].parsed == 50);
+		CPPUNIT_ASSERT(threads[i].matched == 50);
+		
+		threads[i].table = NULL;
+		threads[i].automata = NULL;
+	}
+	
+	// the copies made by the threads were all released
+	CPPUNIT_ASSERT(table.getReferences() == tableReferences);
+	CPPUNIT_ASSERT(automata.getReferences() == automataReferences);
+	
+	delete(grammar->getScannerGrammar());
+	delete(grammar->getParserGrammar());
+	delete(grammar);
+	delete(parser);
+}
+
 Parser *ParserTest::loadParser(ParserType type, Grammar **g, const char *scannerFile,
 		const char *parserFile, const char *inputFile, unsigned int conflicts) {
 	
@@ -193,8 +306,8 @@ void ParserTest::test1Bar(Grammar *grammar, NonTerminal *nonTerminal, const char
 /*****************************************************************************
  * ParserTest::testParser2
  *****************************************************************************/
-void ParserTest::testParser2(Parser *parser, Grammar *grammar) {
-	ParsingTree::Node *node = parser->parse();
+void ParserTest::testParser2(Parser *parser, Grammar *grammar, const TokenTable *tokens) {
+	ParsingTree::Node *node = tokens ? parser->parse(*tokens) : parser->parse();
 	
 	CPPUNIT_ASSERT(node->getNodeType() == ParsingTree::NODE_NON_TERMINAL);
 	
@@ -8,6 +8,7 @@
 
 class Grammar;
 class Parser;
+class TokenTable;
 
 class ParserTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST_SUITE(ParserTest);
@@ -18,6 +19,10 @@ class ParserTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST(slr1Test1);
 	CPPUNIT_TEST(slr1Test2);
 	
+	CPPUNIT_TEST(tokenTableTest);
+	
+	CPPUNIT_TEST(threadTest);
+	
 	CPPUNIT_TEST_SUITE_END();
 	
 	public:
@@ -30,6 +35,10 @@ class ParserTest : public CppUnit::TestFixture {
 		void slr1Test1();
 		void slr1Test2();
 		
+		void tokenTableTest();
+		
+		void threadTest();
+		
 	private:
 		typedef ParsingTree::Node Node;
 		typedef ParsingTree::NonTerminal NonTerminal;
@@ -51,7 +60,8 @@ class ParserTest : public CppUnit::TestFixture {
 		void test1FooDepth2(Grammar *grammar, NonTerminal *nonTerminal);
 		void test1Bar(Grammar *grammar, NonTerminal *nonTerminal, const char *toks);
 		
-		void testParser2(Parser *parser, Grammar *grammar);
+		// parse the tokens of the table if it's not NULL, or the scanner of the parser
+		void testParser2(Parser *parser, Grammar *grammar, const TokenTable *tokens = NULL);
 		void test2Rule1(Grammar *grammar, NonTerminal *nonTerminal);
 		void test2Rule2(Grammar *grammar, NonTerminal *nonTerminal);
 };
@@ -3,6 +3,7 @@
 #include "parser/Automata.h"
 #include "parser/ParserDefs.h"
 #include "parser/Regex.h"
+#include "parser/RegexCompiler.h"
 
 #include <cctype>
 
@@ -194,3 +195,161 @@ void RegexTest::emptyTest() {
 	CPPUNIT_ASSERT(regex.matches(""));
 	CPPUNIT_ASSERT(!regex.matches("a"));
 }
+
+void RegexTest::byteTest() {
+	// UTF-8 encoded characters are matched byte by byte
+	Regex regex1("\xc3\xa9+");
+	Regex regex2(".");
+	Regex regex3("[^a]");
+	Regex regex4("a|b");
+	Regex regex5("\\d+");
+	
+	CPPUNIT_ASSERT(regex1.matches("\xc3\xa9"));
+	CPPUNIT_ASSERT(regex1.matches("\xc3\xa9\xa9"));
+	CPPUNIT_ASSERT(!regex1.matches("\xc3"));
+	CPPUNIT_ASSERT(!regex1.matches("e"));
+	
+	char buf[2];
+	buf[1] = '\0';
+	
+	for (unsigned int i = 128; i < ALPHABET_SIZE; ++i) {
+		buf[0] = i;
+		CPPUNIT_ASSERT(regex2.matches(buf));
+		CPPUNIT_ASSERT(regex3.matches(buf));
+		CPPUNIT_ASSERT(!regex4.matches(buf));
+		CPPUNIT_ASSERT(!regex5.matches(buf));
+	}
+	
+	// the characters with the same transitions share a class
+	CPPUNIT_ASSERT(regex4.getAutomata()->getNumClasses() == 2);
+	CPPUNIT_ASSERT(regex5.getAutomata()->getNumClasses() == 2);
+	
+	const unsigned char *inputClasses = regex5.getAutomata()->getInputClasses();
+	for (unsigned int i = 0; i < ALPHABET_SIZE; ++i) {
+		if (isdigit(i)) CPPUNIT_ASSERT(inputClasses[i] == inputClasses['0']);
+		else CPPUNIT_ASSERT(inputClasses[i] == inputClasses['a']);
+	}
+}
+
+void RegexTest::searchTest() {
+	Regex regex1("error: \\d+");
+	Regex regex2("\\d+|x");
+	Regex regex3("abcd|c");
+	Regex regex4("a*");
+	
+	CPPUNIT_ASSERT(regex1.getPrefix() == "error: ");
+	CPPUNIT_ASSERT(regex2.getPrefix().empty());
+	
+	Regex::Match match;
+	std::string text = "warning: 1, error: x, error: 42 error: 7";
+	
+	CPPUNIT_ASSERT(regex1.search(text, match));
+	CPPUNIT_ASSERT(match.position == 22 && match.length == 9);
+	CPPUNIT_ASSERT(regex1.search(text, match, 23));
+	CPPUNIT_ASSERT(match.position == 32 && match.length == 8);
+	CPPUNIT_ASSERT(!regex1.search(text, match, 33));
+	CPPUNIT_ASSERT(!regex1.search(text, match, text.size() + 1));
+	
+	// the leftmost match, then the longest one
+	CPPUNIT_ASSERT(regex2.search("ab x 123 4", match));
+	CPPUNIT_ASSERT(match.position == 3 && match.length == 1);
+	CPPUNIT_ASSERT(regex2.search("ab x 123 4", match, 4));
+	CPPUNIT_ASSERT(match.position == 5 && match.length == 3);
+	CPPUNIT_ASSERT(!regex2.search("abc", match));
+	
+	// the match that ends first isn't the leftmost
+	CPPUNIT_ASSERT(regex3.search("xabcd", match));
+	CPPUNIT_ASSERT(match.position == 1 && match.length == 4);
+	CPPUNIT_ASSERT(regex3.search("xabcx", match));
+	CPPUNIT_ASSERT(match.position == 3 && match.length == 1);
+	
+	CPPUNIT_ASSERT(regex4.search("bbaa", match));
+	CPPUNIT_ASSERT(match.position == 0 && match.length == 0);
+	CPPUNIT_ASSERT(regex4.search("bbaa", match, 2));
+	CPPUNIT_ASSERT(match.position == 2 && match.length == 2);
+	CPPUNIT_ASSERT(regex4.search("bbaa", match, 4));
+	CPPUNIT_ASSERT(match.position == 4 && match.length == 0);
+	
+	// the characters after a '\0' are searched too
+	CPPUNIT_ASSERT(regex2.search(std::string("a\0b7", 4), match));
+	CPPUNIT_ASSERT(match.position == 3 && match.length == 1);
+}
+
+void RegexTest::findAllTest() {
+	Regex regex1("\\d+");
+	Regex regex2(", *");
+	Regex regex3("b*");
+	
+	Regex::MatchList matches;
+	regex1.findAll("a1b22c333", matches);
+	CPPUNIT_ASSERT(matches.size() == 3);
+	CPPUNIT_ASSERT(matches[0].position == 1 && matches[0].length == 1);
+	CPPUNIT_ASSERT(matches[1].position == 3 && matches[1].length == 2);
+	CPPUNIT_ASSERT(matches[2].position == 6 && matches[2].length == 3);
+	
+	matches.clear();
+	regex3.findAll("abba", matches);
+	CPPUNIT_ASSERT(matches.size() == 4);
+	CPPUNIT_ASSERT(matches[0].position == 0 && matches[0].length == 0);
+	CPPUNIT_ASSERT(matches[1].position == 1 && matches[1].length == 2);
+	CPPUNIT_ASSERT(matches[2].position == 3 && matches[2].length == 0);
+	CPPUNIT_ASSERT(matches[3].position == 4 && matches[3].length == 0);
+	
+	std::string text = "a, b,,c,  ";
+	Regex::MatchList pieces;
+	regex2.split(text, pieces);
+	CPPUNIT_ASSERT(pieces.size() == 5);
+	
+	const char *expected[] = {"a", "b", "", "c", ""};
+	for (unsigned int i = 0; i < pieces.size(); ++i) {
+		CPPUNIT_ASSERT(text.substr(pieces[i].position, pieces[i].length) == expected[i]);
+	}
+	
+	// the empty matches don't split
+	pieces.clear();
+	regex3.split("abba", pieces);
+	CPPUNIT_ASSERT(pieces.size() == 2);
+	CPPUNIT_ASSERT(pieces[0].position == 0 && pieces[0].length == 1);
+	CPPUNIT_ASSERT(pieces[1].position == 3 && pieces[1].length == 1);
+	
+	pieces.clear();
+	regex1.split("", pieces);
+	CPPUNIT_ASSERT(pieces.size() == 1 && pieces[0].length == 0);
+}
+
+void RegexTest::cacheTest() {
+	RegexCompiler compiler;
+	compiler.setCacheSize(2);
+	
+	Pointer<const Automata> automata1 = compiler.getAutomata("a+b");
+	Pointer<const Automata> automata2 = compiler.getAutomata("a+b");
+	CPPUNIT_ASSERT(automata1 == automata2);
+	CPPUNIT_ASSERT(compiler.getCacheHits() == 1);
+	CPPUNIT_ASSERT(compiler.getCacheMisses() == 1);
+	
+	// "c" is used after "a+b", so "a+b" is removed first
+	compiler.getAutomata("c");
+	compiler.getAutomata("a+b");
+	compiler.getAutomata("d");
+	CPPUNIT_ASSERT(compiler.getAutomata("a+b") == automata1);
+	CPPUNIT_ASSERT(compiler.getAutomata("c").getPtr());
+	CPPUNIT_ASSERT(compiler.getCacheHits() == 3);
+	CPPUNIT_ASSERT(compiler.getCacheMisses() == 4);
+	
+	// the removed automatas are kept by their users
+	compiler.clearCache();
+	Pointer<const Automata> automata3 = compiler.getAutomata("a+b");
+	CPPUNIT_ASSERT(automata3 != automata1);
+	CPPUNIT_ASSERT(*automata3 == *automata1);
+	CPPUNIT_ASSERT(automata1->accept("aab"));
+	
+	compiler.setCacheSize(0);
+	CPPUNIT_ASSERT(compiler.getAutomata("a+b") != automata3);
+	CPPUNIT_ASSERT(compiler.getCacheMisses() == 6);
+	
+	// the regexes with the same pattern share the automata
+	Regex regex1("x*y");
+	Regex regex2(std::string("x*y"));
+	CPPUNIT_ASSERT(regex1.getAutomata() == regex2.getAutomata());
+	CPPUNIT_ASSERT(regex2.matches("xxy"));
+}
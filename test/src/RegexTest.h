@@ -14,6 +14,13 @@ class RegexTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST(subexpressionTest);
 	
 	CPPUNIT_TEST(emptyTest);
+	
+	CPPUNIT_TEST(byteTest);
+	
+	CPPUNIT_TEST(searchTest);
+	CPPUNIT_TEST(findAllTest);
+	
+	CPPUNIT_TEST(cacheTest);
 	CPPUNIT_TEST_SUITE_END();
 	
 	public:
@@ -28,6 +35,13 @@ class RegexTest : public CppUnit::TestFixture {
 		void subexpressionTest();
 		
 		void emptyTest();
+		
+		void byteTest();
+		
+		void searchTest();
+		void findAllTest();
+		
+		void cacheTest();
 };
 
 #endif
@@ -2,12 +2,25 @@
 
 #include "TestDefs.h"
 
+#include "parser/Automata.h"
 #include "parser/FileInput.h"
 #include "parser/Grammar.h"
 #include "parser/GrammarLoader.h"
+#include "parser/KeywordTable.h"
+#include "parser/ListInput.h"
+#include "parser/MemoryInput.h"
+#include "parser/MmapInput.h"
 #include "parser/ScannerGrammar.h"
 #include "parser/Pointer.h"
 #include "parser/Scanner.h"
+#include "parser/ScannerSession.h"
+#include "parser/TokenPool.h"
+#include "parser/TokenTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ScannerTest);
 
@@ -92,6 +105,338 @@ void ScannerTest::test2() {
 	delete(grammar);
 }
 
+void ScannerTest::mmapTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner1.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	MmapInput *input = new MmapInput(INPUT_FOLDER + "input1.txt");
+	Scanner scanner(automata, input);
+	
+	const char *tokens[5] = {"a", "32", "aa", "a1", "1.1"};
+	for (unsigned int i = 0; i < 5; ++i) {
+		Token *token = scanner.nextToken();
+		CPPUNIT_ASSERT(token);
+		CPPUNIT_ASSERT(token->getToken() == tokens[i]);
+		
+		// the token can be read from the mapped file
+		const char *mapped = input->getData() + token->getInputPos();
+		CPPUNIT_ASSERT(std::string(mapped, token->getToken().size()) == tokens[i]);
+		
+		delete(token);
+	}
+	
+	CPPUNIT_ASSERT(!scanner.nextToken());
+}
+
+void ScannerTest::listInputTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	Scanner fileScanner(automata, new FileInput(INPUT_FOLDER + "input_c1.txt"));
+	
+	// the tokens continue from one chunk to the next
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	ListInput *listInput = new ListInput();
+	
+	unsigned int chunkSize = 1;
+	std::string chunk;
+	char c;
+	while ((c = fileInput.nextChar())) {
+		chunk.push_back(c);
+		if (chunk.size() == chunkSize) {
+			listInput->addInput(new MemoryInput(chunk));
+			chunk.clear();
+			chunkSize = chunkSize % 5 + 1;
+		}
+	}
+	if (!chunk.empty()) listInput->addInput(new MemoryInput(chunk));
+	
+	Scanner listScanner(automata, listInput);
+	
+	Token *token;
+	while ((token = fileScanner.nextToken())) {
+		Token *listToken = listScanner.nextToken();
+		CPPUNIT_ASSERT(listToken);
+		CPPUNIT_ASSERT(listToken->getTokenTypeId() == token->getTokenTypeId());
+		CPPUNIT_ASSERT(listToken->getToken() == token->getToken());
+		
+		delete(listToken);
+		delete(token);
+	}
+	
+	CPPUNIT_ASSERT(!listScanner.nextToken());
+}
+
+void ScannerTest::recordTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	std::string data;
+	char c;
+	while ((c = fileInput.nextChar())) data.push_back(c);
+	
+	Scanner tokenScanner(automata, new MemoryInput(data));
+	Scanner recordScanner(automata, new MemoryInput(data));
+	
+	// a small array, so it's reused many times
+	TokenRecord records[7];
+	unsigned int count;
+	unsigned int total = 0;
+	
+	while ((count = recordScanner.nextTokens(records, 7, true))) {
+		for (unsigned int i = 0; i < count; ++i) {
+			Token *token = tokenScanner.nextToken();
+			CPPUNIT_ASSERT(token);
+			
+			CPPUNIT_ASSERT(records[i].tokenTypeId == token->getTokenTypeId());
+			CPPUNIT_ASSERT(records[i].inputPos == token->getInputPos());
+			CPPUNIT_ASSERT(data.substr(records[i].inputPos, records[i].length) == token->getToken());
+			CPPUNIT_ASSERT(records[i].line == token->getInputLocation().getLine());
+			CPPUNIT_ASSERT(records[i].column == token->getInputLocation().getColumn());
+			
+			delete(token);
+		}
+		
+		total += count;
+		if (count < 7) break;
+	}
+	
+	CPPUNIT_ASSERT(total > 0);
+	CPPUNIT_ASSERT(!tokenScanner.nextToken());
+	CPPUNIT_ASSERT(!recordScanner.nextTokens(records, 7, false));
+}
+
+void ScannerTest::tokenTableTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	std::string data;
+	char c;
+	while ((c = fileInput.nextChar())) data.push_back(c);
+	
+	for (unsigned int i = 0; i < 2; ++i) {
+		// the second time use a ListInput of small chunks,
+		// so many tokens continue in the next buffer
+		Input *inputs[2];
+		for (unsigned int j = 0; j < 2; ++j) {
+			if (i == 0) inputs[j] = new MemoryInput(data);
+			else {
+				ListInput *listInput = new ListInput();
+				for (unsigned int pos = 0; pos < data.size(); pos += 3)
+					listInput->addInput(new MemoryInput(data.substr(pos, 3)));
+				inputs[j] = listInput;
+			}
+		}
+		
+		Scanner scanner(automata, inputs[0]);
+		
+		TokenTable tokens;
+		scanner.tokenizeAll(inputs[1], tokens);
+		
+		CPPUNIT_ASSERT(tokens.size() > 0);
+		
+		for (unsigned int j = 0; j < tokens.size(); ++j) {
+			Token *token = scanner.nextToken();
+			CPPUNIT_ASSERT(token);
+			
+			CPPUNIT_ASSERT(tokens.getTokenTypeId(j) == token->getTokenTypeId());
+			CPPUNIT_ASSERT(tokens.getInputPos(j) == token->getInputPos());
+			CPPUNIT_ASSERT(tokens.getToken(j) == token->getToken());
+			CPPUNIT_ASSERT(tokens.getLength(j) == token->getToken().size());
+			CPPUNIT_ASSERT(tokens.getLine(j) == token->getInputLocation().getLine());
+			CPPUNIT_ASSERT(tokens.getColumn(j) == token->getInputLocation().getColumn());
+			
+			delete(token);
+		}
+		
+		CPPUNIT_ASSERT(!scanner.nextToken());
+		CPPUNIT_ASSERT(tokens.getEndLocation().getLine() == scanner.getInput()->getInputLine());
+		
+		delete(inputs[1]);
+	}
+	
+	// the characters read to find the tokens don't depend on the buffers,
+	// with small windows many tokens are read by nextToken()
+	Scanner scanner(automata);
+	
+	TokenTable memoryTokens;
+	MemoryInput memoryInput(data);
+	scanner.tokenizeAll(&memoryInput, memoryTokens);
+	
+	TokenTable fileTokens;
+	FileInput smallInput(INPUT_FOLDER + "input_c1.txt");
+	smallInput.setReadAhead(16, 0);
+	scanner.tokenizeAll(&smallInput, fileTokens);
+	
+	CPPUNIT_ASSERT(fileTokens.size() == memoryTokens.size());
+	for (unsigned int i = 0; i < fileTokens.size(); ++i) {
+		CPPUNIT_ASSERT(fileTokens.getScanEnd(i) == memoryTokens.getScanEnd(i));
+		CPPUNIT_ASSERT(fileTokens.getScanEnd(i) > fileTokens.getInputPos(i) + fileTokens.getLength(i));
+	}
+}
+
+void ScannerTest::skipTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	TokenTypeID idId = grammar->getTokenId("IDENTIFIER");
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	// the whitespaces and the inside of the comments are skipped
+	unsigned int skipWhile = 0;
+	unsigned int skipUntil = 0;
+	for (unsigned int i = 0; i < automata->getAutomata()->getNumStates(); ++i) {
+		const ScannerAutomata::SkipState & skip = automata->getSkipState(i);
+		if (skip.type == ScannerAutomata::SKIP_WHILE) ++skipWhile;
+		if (skip.type == ScannerAutomata::SKIP_UNTIL) ++skipUntil;
+	}
+	CPPUNIT_ASSERT(skipWhile > 0);
+	CPPUNIT_ASSERT(skipUntil > 0);
+	
+	// runs of all sizes, so the end of the run is at every position of the SIMD blocks
+	std::string data;
+	std::vector<unsigned int> positions;
+	std::vector<unsigned int> lines;
+	unsigned int line = 1;
+	
+	for (unsigned int size = 0; size < 80; ++size) {
+		positions.push_back(data.size());
+		lines.push_back(line);
+		data += "a";
+		
+		data += " " + std::string(size, size % 2 ? ' ' : '\t');
+		data += "/*";
+		for (unsigned int i = 0; i < size; ++i) data += i % 7 ? 'x' : '*';
+		data += "*/";
+		data += "//" + std::string(size, '/') + "\n";
+		++line;
+		data += std::string(size, '\n');
+		line += size;
+	}
+	
+	for (unsigned int i = 0; i < 2; ++i) {
+		// the second time the runs continue in the next buffer
+		Input *input;
+		if (i == 0) input = new MemoryInput(data);
+		else {
+			ListInput *listInput = new ListInput();
+			for (unsigned int pos = 0; pos < data.size(); pos += 21)
+				listInput->addInput(new MemoryInput(data.substr(pos, 21)));
+			input = listInput;
+		}
+		
+		Scanner scanner(automata, input);
+		
+		for (unsigned int j = 0; j < positions.size(); ++j) {
+			Token *token = scanner.nextToken();
+			CPPUNIT_ASSERT(token);
+			
+			CPPUNIT_ASSERT(token->getTokenTypeId() == idId);
+			CPPUNIT_ASSERT(token->getToken() == "a");
+			
+			// the locations of a ListInput are in each of its inputs
+			if (i == 0) {
+				CPPUNIT_ASSERT(token->getInputLocation().getLine() == lines[j]);
+				CPPUNIT_ASSERT(token->getInputPos() == positions[j]);
+			}
+			
+			delete(token);
+		}
+		
+		CPPUNIT_ASSERT(!scanner.nextToken());
+	}
+	
+	TokenTable tokens;
+	MemoryInput input(data);
+	automata->tokenize(&input, tokens);
+	
+	CPPUNIT_ASSERT(tokens.size() == positions.size());
+	for (unsigned int j = 0; j < tokens.size(); ++j) {
+		CPPUNIT_ASSERT(tokens.getInputPos(j) == positions[j]);
+		CPPUNIT_ASSERT(tokens.getLine(j) == lines[j]);
+	}
+}
+
+void ScannerTest::keywordTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	TokenTypeID idId = grammar->getTokenId("IDENTIFIER");
+	TokenTypeID whileId = grammar->getTokenId("WHILE");
+	TokenTypeID ifId = grammar->getTokenId("IF");
+	TokenTypeID doId = grammar->getTokenId("DO");
+	TokenTypeID doubleId = grammar->getTokenId("DOUBLE");
+	TokenTypeID volatileId = grammar->getTokenId("VOLATILE");
+	TokenTypeID mulId = grammar->getTokenId("MUL");
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	// all the C keywords are shadowed by IDENTIFIER, but not the operators
+	const KeywordTable & keywords = automata->getKeywords();
+	CPPUNIT_ASSERT(keywords.size() == 32);
+	for (unsigned int i = 0; i < keywords.size(); ++i) {
+		CPPUNIT_ASSERT(keywords.getTokenTypeId(i) == idId);
+	}
+	keywords.sanityCheck();
+	
+	std::string data = "while whilex _while if iff\ndo double doubles volatile* d";
+	TokenTypeID ids[] = {whileId, idId, idId, ifId, idId, doId, doubleId, idId, volatileId,
+			mulId, idId};
+	unsigned int numIds = sizeof(ids) / sizeof(TokenTypeID);
+	
+	for (unsigned int i = 0; i < 2; ++i) {
+		// the second time the keywords continue in the next buffer
+		Input *input;
+		if (i == 0) input = new MemoryInput(data);
+		else {
+			ListInput *listInput = new ListInput();
+			for (unsigned int pos = 0; pos < data.size(); pos += 2)
+				listInput->addInput(new MemoryInput(data.substr(pos, 2)));
+			input = listInput;
+		}
+		
+		Scanner scanner(automata, input);
+		for (unsigned int j = 0; j < numIds; ++j) tokenAssert(scanner, ids[j]);
+		CPPUNIT_ASSERT(!scanner.nextToken());
+	}
+	
+	TokenTable tokens;
+	MemoryInput input(data);
+	automata->tokenize(&input, tokens);
+	
+	CPPUNIT_ASSERT(tokens.size() == numIds);
+	for (unsigned int j = 0; j < numIds; ++j) CPPUNIT_ASSERT(tokens.getTokenTypeId(j) == ids[j]);
+}
+
 void ScannerTest::tokenAssert(Scanner & scanner, TokenTypeID id) {
 	Token *token = scanner.nextToken();
 	CPPUNIT_ASSERT(token);
@@ -107,3 +452,456 @@ void ScannerTest::tokenAssert(Scanner & scanner, TokenTypeID id, const std::stri
 	CPPUNIT_ASSERT(token->getToken() == tok);
 	delete(token);
 }
+
+void ScannerTest::parallelTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	std::string code;
+	char c;
+	while ((c = fileInput.nextChar())) code.push_back(c);
+	
+	// a large input, with long comments where the chunks may start in the
+	// middle of a token (the lines of the comments are not valid tokens)
+	std::string data;
+	for (unsigned int i = 0; data.size() < 2 * 1024 * 1024; ++i) {
+		data += code;
+		if (i % 16 == 0) {
+			data += "/*\n";
+			for (unsigned int j = 0; j < 200; ++j) data += "\" not a string, ` not a token\n";
+			data += "*/ ";
+		}
+	}
+	
+	Scanner scanner(automata, new MemoryInput(data));
+	
+	TokenTable sequential;
+	MemoryInput sequentialInput(data);
+	scanner.tokenizeAll(&sequentialInput, sequential);
+	
+	CPPUNIT_ASSERT(sequential.size() > 0);
+	
+	for (unsigned int numThreads = 2; numThreads <= 8; numThreads += 3) {
+		TokenTable tokens;
+		MemoryInput parallelInput(data);
+		scanner.tokenizeAll(&parallelInput, tokens, numThreads);
+		
+		CPPUNIT_ASSERT(tokens.size() == sequential.size());
+		
+		for (unsigned int j = 0; j < tokens.size(); ++j) {
+			CPPUNIT_ASSERT(tokens.getTokenTypeId(j) == sequential.getTokenTypeId(j));
+			CPPUNIT_ASSERT(tokens.getInputPos(j) == sequential.getInputPos(j));
+			CPPUNIT_ASSERT(tokens.getToken(j) == sequential.getToken(j));
+			CPPUNIT_ASSERT(tokens.getLine(j) == sequential.getLine(j));
+			CPPUNIT_ASSERT(tokens.getColumn(j) == sequential.getColumn(j));
+			CPPUNIT_ASSERT(tokens.getScanEnd(j) == sequential.getScanEnd(j));
+		}
+		
+		CPPUNIT_ASSERT(tokens.getEndLocation().getLine() == sequential.getEndLocation().getLine());
+		CPPUNIT_ASSERT(tokens.getEndLocation().getColumn() == sequential.getEndLocation().getColumn());
+		CPPUNIT_ASSERT(parallelInput.getInputPos() == data.size());
+	}
+	
+	// an invalid token in the last chunk is an error in its line
+	data += "\n`\n";
+	unsigned int lastLine = sequential.getEndLocation().getLine() + 1;
+	
+	try {
+		MemoryInput parallelInput(data);
+		scanner.tokenizeAll(&parallelInput, sequential, 4);
+		CPPUNIT_ASSERT(false);
+	}
+	catch (ParserError & error) {
+		CPPUNIT_ASSERT(error.getLineNumber() == lastLine);
+		CPPUNIT_ASSERT(error.getRawMessage() == "Unexpected character \'`\'.");
+	}
+}
+
+void ScannerTest::tokenPoolTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	std::string data;
+	char c;
+	while ((c = fileInput.nextChar())) data.push_back(c);
+	
+	Pointer<TokenPool> pool = new TokenPool();
+	std::map<std::string, const std::string *> pooled;
+	
+	// the pool is shared by the scanners of two inputs, the second one read
+	// by small chunks so the tokens continue in the next buffer
+	for (unsigned int i = 0; i < 2; ++i) {
+		Input *input;
+		if (i == 0) input = new MemoryInput(data);
+		else {
+			ListInput *listInput = new ListInput();
+			for (unsigned int pos = 0; pos < data.size(); pos += 3)
+				listInput->addInput(new MemoryInput(data.substr(pos, 3)));
+			input = listInput;
+		}
+		
+		Scanner scanner(automata, new MemoryInput(data));
+		Scanner poolScanner(automata, input);
+		poolScanner.setTokenPool(pool);
+		CPPUNIT_ASSERT(poolScanner.getTokenPool() == pool);
+		
+		Token *token;
+		while ((token = scanner.nextToken())) {
+			Token *poolToken = poolScanner.nextToken();
+			CPPUNIT_ASSERT(poolToken);
+			CPPUNIT_ASSERT(!token->getPooledToken());
+			CPPUNIT_ASSERT(poolToken->getPooledToken());
+			
+			CPPUNIT_ASSERT(poolToken->getTokenTypeId() == token->getTokenTypeId());
+			CPPUNIT_ASSERT(poolToken->getToken() == token->getToken());
+			if (i == 0) CPPUNIT_ASSERT(poolToken->getInputPos() == token->getInputPos());
+			
+			// the same text is always the same string of the pool
+			const std::string *& text = pooled[token->getToken()];
+			if (!text) text = poolToken->getPooledToken();
+			CPPUNIT_ASSERT(poolToken->getPooledToken() == text);
+			
+			// a copy has its own text or the same pooled one
+			Token copy(*token);
+			CPPUNIT_ASSERT(copy.getToken() == token->getToken() && !copy.getPooledToken());
+			copy = *poolToken;
+			CPPUNIT_ASSERT(copy.getPooledToken() == text);
+			copy.setToken(copy.getToken());
+			CPPUNIT_ASSERT(copy.getToken() == *text && !copy.getPooledToken());
+			
+			delete(token);
+			delete(poolToken);
+		}
+		
+		CPPUNIT_ASSERT(!poolScanner.nextToken());
+	}
+	
+	CPPUNIT_ASSERT(pool->size() == pooled.size());
+	pool->sanityCheck();
+	
+	// a pool with more texts than its initial slots
+	TokenPool numbers;
+	for (unsigned int i = 0; i < 2000; ++i) {
+		std::stringstream text;
+		text << i;
+		CPPUNIT_ASSERT(*numbers.intern(text.str()) == text.str());
+	}
+	for (unsigned int i = 0; i < 2000; ++i) {
+		std::stringstream text;
+		text << i;
+		const std::string *pooledText = numbers.intern(text.str());
+		CPPUNIT_ASSERT(numbers.intern(pooledText->data(), pooledText->size()) == pooledText);
+	}
+	CPPUNIT_ASSERT(numbers.size() == 2000);
+	numbers.sanityCheck();
+}
+
+// a MemoryInput that counts how many times its position is changed
+class SeekCountInput : public MemoryInput {
+	public:
+		SeekCountInput(const std::string & str) : MemoryInput(str), seeks(0) {}
+		
+		virtual void setInputPos(unsigned int pos) {
+			++seeks;
+			MemoryInput::setInputPos(pos);
+		}
+		
+		unsigned int seeks;
+};
+
+void ScannerTest::rollbackTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	std::string data;
+	char c;
+	while ((c = fileInput.nextChar())) data.push_back(c);
+	
+	// the whole input is in a single window, the scanner never goes back
+	SeekCountInput *input = new SeekCountInput(data);
+	Scanner scanner(automata, input);
+	
+	unsigned int numTokens = 0;
+	Token *token;
+	while ((token = scanner.nextToken())) {
+		CPPUNIT_ASSERT(token->getToken() == data.substr(token->getInputPos(), token->getToken().size()));
+		++numTokens;
+		delete(token);
+	}
+	
+	CPPUNIT_ASSERT(numTokens > 0);
+	CPPUNIT_ASSERT(input->seeks == 0);
+	
+	SeekCountInput *recordInput = new SeekCountInput(data);
+	scanner.setInput(recordInput);
+	delete(input);
+	
+	TokenRecord records[16];
+	unsigned int numRecords = 0;
+	unsigned int count;
+	while ((count = scanner.nextTokens(records, 16, true))) numRecords += count;
+	
+	CPPUNIT_ASSERT(numRecords == numTokens);
+	CPPUNIT_ASSERT(recordInput->seeks == 0);
+}
+
+// check that the tokens of two tables are the same
+static void assertSameTokens(const TokenTable & tokens, const TokenTable & expected) {
+	CPPUNIT_ASSERT(tokens.size() == expected.size());
+	
+	for (unsigned int i = 0; i < tokens.size(); ++i) {
+		CPPUNIT_ASSERT(tokens.getTokenTypeId(i) == expected.getTokenTypeId(i));
+		CPPUNIT_ASSERT(tokens.getInputPos(i) == expected.getInputPos(i));
+		CPPUNIT_ASSERT(tokens.getToken(i) == expected.getToken(i));
+		CPPUNIT_ASSERT(tokens.getLine(i) == expected.getLine(i));
+		CPPUNIT_ASSERT(tokens.getColumn(i) == expected.getColumn(i));
+		CPPUNIT_ASSERT(tokens.getScanEnd(i) == expected.getScanEnd(i));
+	}
+	
+	CPPUNIT_ASSERT(tokens.getEndLocation().getLine() == expected.getEndLocation().getLine());
+	CPPUNIT_ASSERT(tokens.getEndLocation().getColumn() == expected.getEndLocation().getColumn());
+}
+
+void ScannerTest::retokenizeTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	std::string code;
+	char c;
+	while ((c = fileInput.nextChar())) code.push_back(c);
+	
+	std::string data;
+	for (unsigned int i = 0; i < 20; ++i) data += code;
+	
+	Scanner scanner(automata);
+	
+	// each edit: the position, the characters removed and the characters inserted
+	struct Edit {
+		size_t pos;
+		size_t removed;
+		const char *inserted;
+	};
+	Edit edits[] = {
+		{0, 0, "int x;\n"},
+		{0, 3, ""},
+		{3, 0, "abc"},
+		{code.size() + 10, 0, "\n\n  foo = bar + 1;\n"},
+		{code.size() + 10, 5, ""},
+		{code.size() * 3 + 7, 2, "/* a comment\n */"},
+		{code.size() * 5 + 1, 0, "/*"},
+		{code.size() * 5, 0, "*/ 12.5e3"},
+		{code.size() * 7 + 20, 0, "\"a string\""},
+		{code.size() * 9, 30, "x"},
+		{data.size() - 1, 1, ""},
+		{data.size() - 3, 0, "\n\nlast"}
+	};
+	
+	TokenTable tokens;
+	MemoryInput *input = new MemoryInput(data);
+	scanner.tokenizeAll(input, tokens);
+	delete(input);
+	
+	for (unsigned int i = 0; i < sizeof(edits) / sizeof(Edit); ++i) {
+		const Edit & edit = edits[i];
+		unsigned int inserted = strlen(edit.inserted);
+		
+		std::string newData = data;
+		newData.replace(edit.pos, edit.removed, edit.inserted);
+		
+		TokenTable oldTokens = tokens;
+		
+		input = new MemoryInput(newData);
+		TokenChange change = scanner.retokenize(input, tokens, edit.pos, edit.removed, inserted);
+		delete(input);
+		
+		TokenTable expected;
+		input = new MemoryInput(newData);
+		scanner.tokenizeAll(input, expected);
+		delete(input);
+		
+		assertSameTokens(tokens, expected);
+		
+		// only the tokens near the edit changed, the others were moved
+		CPPUNIT_ASSERT(change.removed < 10 && change.added < 10);
+		CPPUNIT_ASSERT(oldTokens.size() - change.removed + change.added == tokens.size());
+		
+		for (unsigned int j = 0; j < change.first; ++j) {
+			CPPUNIT_ASSERT(tokens.getInputPos(j) == oldTokens.getInputPos(j));
+		}
+		for (unsigned int j = change.first + change.added; j < tokens.size(); ++j) {
+			unsigned int old = j - change.added + change.removed;
+			CPPUNIT_ASSERT(tokens.getInputPos(j) + edit.removed == oldTokens.getInputPos(old) + inserted);
+			CPPUNIT_ASSERT(tokens.getToken(j) == oldTokens.getToken(old));
+		}
+		
+		data = newData;
+	}
+	
+	// edits of small inputs, where a token before the edit read its characters
+	struct InputEdit {
+		const char *data;
+		size_t pos;
+		size_t removed;
+		const char *inserted;
+	};
+	InputEdit inputEdits[] = {
+		// the edit closes an unterminated comment
+		{"a /* b\nc d;\n", 6, 0, "*/"},
+		// the edit opens a comment closed further down
+		{"a b;\nc */ d;\n", 2, 0, "/*"},
+		// removing a character closes a comment
+		{"a /* b * / c;\n", 8, 1, ""},
+		// the token that read the characters removed from the end changes
+		{"x+=", 2, 1, ""},
+		{"a <<=", 4, 1, ""},
+		{"x ->", 3, 1, ""},
+		{"\"str\\\"ing\"}", 9, 2, ""}
+	};
+	
+	for (unsigned int i = 0; i < sizeof(inputEdits) / sizeof(InputEdit); ++i) {
+		const InputEdit & edit = inputEdits[i];
+		
+		std::string oldData = edit.data;
+		std::string newData = oldData;
+		newData.replace(edit.pos, edit.removed, edit.inserted);
+		
+		TokenTable editTokens;
+		input = new MemoryInput(oldData);
+		scanner.tokenizeAll(input, editTokens);
+		delete(input);
+		
+		TokenTable expected;
+		bool valid = true;
+		try {
+			input = new MemoryInput(newData);
+			scanner.tokenizeAll(input, expected);
+		}
+		catch (ParserError & error) {
+			valid = false;
+		}
+		delete(input);
+		
+		try {
+			input = new MemoryInput(newData);
+			scanner.retokenize(input, editTokens, edit.pos, edit.removed, strlen(edit.inserted));
+			CPPUNIT_ASSERT(valid);
+		}
+		catch (ParserError & error) {
+			// the error is where the invalid token starts
+			CPPUNIT_ASSERT(!valid);
+			CPPUNIT_ASSERT(error.getLineNumber() == 1 && error.getLineColumn() == 0);
+		}
+		delete(input);
+		
+		if (valid) assertSameTokens(editTokens, expected);
+	}
+	
+	// an input that isn't in memory is read again
+	ListInput *listInput = new ListInput();
+	listInput->addInput(new MemoryInput(data.substr(0, 100)));
+	listInput->addInput(new MemoryInput(data.substr(100)));
+	
+	TokenTable oldTokens = tokens;
+	TokenChange change = scanner.retokenize(listInput, tokens, 0, 0, 0);
+	delete(listInput);
+	
+	CPPUNIT_ASSERT(change.first == 0);
+	CPPUNIT_ASSERT(change.removed == oldTokens.size() && change.added == tokens.size());
+	CPPUNIT_ASSERT(tokens.size() == oldTokens.size());
+}
+
+void ScannerTest::sessionTest() {
+	Grammar *grammar = new Grammar();
+	GrammarLoader::loadScanner(grammar, GRAMMAR_FOLDER + "scanner_c.bnf");
+	ScannerGrammar *scannerGrammar = grammar->getScannerGrammar();
+	Pointer<ScannerAutomata> automata = scannerGrammar->compile(grammar);
+	
+	delete(scannerGrammar);
+	delete(grammar);
+	
+	FileInput fileInput(INPUT_FOLDER + "input_c1.txt");
+	std::string code;
+	char c;
+	while ((c = fileInput.nextChar())) code.push_back(c);
+	
+	// the tokens need to look ahead in the next chunks, like the number 1.5e
+	std::string data = "/* comment */ 1.5e+ x\n" + code + "a.b 12.e5 // last";
+	
+	Scanner scanner(automata);
+	TokenTable expected;
+	MemoryInput *input = new MemoryInput(data, "input");
+	scanner.tokenizeAll(input, expected);
+	delete(input);
+	
+	// chunks of every size from a single character
+	for (unsigned int chunkSize = 1; chunkSize <= 17; chunkSize += 4) {
+		ScannerSession session(automata);
+		
+		for (unsigned int pos = 0; pos < data.size(); pos += chunkSize) {
+			unsigned int size = chunkSize;
+			if (pos + size > data.size()) size = data.size() - pos;
+			session.feed(data.data() + pos, size);
+			
+			CPPUNIT_ASSERT(session.getPendingChars() <= pos + size);
+		}
+		
+		session.finish();
+		CPPUNIT_ASSERT(session.getPendingChars() == 0);
+		assertSameTokens(session.getTokens(), expected);
+	}
+	
+	// the tokens removed after each chunk
+	ScannerSession session(automata);
+	unsigned int numTokens = 0;
+	for (unsigned int pos = 0; pos < data.size(); pos += 100) {
+		session.feed(data.data() + pos, std::min((unsigned int)data.size() - pos, 100u));
+		
+		TokenTable & tokens = session.getTokens();
+		for (unsigned int i = 0; i < tokens.size(); ++i, ++numTokens) {
+			CPPUNIT_ASSERT(tokens.getTokenTypeId(i) == expected.getTokenTypeId(numTokens));
+			CPPUNIT_ASSERT(tokens.getInputPos(i) == expected.getInputPos(numTokens));
+		}
+		tokens.clear();
+	}
+	session.finish();
+	numTokens += session.getTokens().size();
+	CPPUNIT_ASSERT(numTokens == expected.size());
+	
+	// an invalid character
+	ScannerSession errorSession(automata);
+	errorSession.feed("int a", 5);
+	try {
+		errorSession.feed(" = @;", 5);
+		
+		// should have thrown a ParserError
+		CPPUNIT_ASSERT(false);
+	}
+	catch (ParserError & error) {
+		CPPUNIT_ASSERT(error.getLineNumber() == 1);
+		CPPUNIT_ASSERT(error.getLineColumn() == 8);
+	}
+}
@@ -13,6 +13,17 @@ class ScannerTest : public CppUnit::TestFixture {
 	
 	CPPUNIT_TEST(test1);
 	CPPUNIT_TEST(test2);
+	CPPUNIT_TEST(mmapTest);
+	CPPUNIT_TEST(listInputTest);
+	CPPUNIT_TEST(recordTest);
+	CPPUNIT_TEST(tokenTableTest);
+	CPPUNIT_TEST(skipTest);
+	CPPUNIT_TEST(keywordTest);
+	CPPUNIT_TEST(parallelTest);
+	CPPUNIT_TEST(tokenPoolTest);
+	CPPUNIT_TEST(rollbackTest);
+	CPPUNIT_TEST(retokenizeTest);
+	CPPUNIT_TEST(sessionTest);
 	
 	CPPUNIT_TEST_SUITE_END();
 	
@@ -22,6 +33,17 @@ class ScannerTest : public CppUnit::TestFixture {
 		
 		void test1();
 		void test2();
+		void mmapTest();
+		void listInputTest();
+		void recordTest();
+		void tokenTableTest();
+		void skipTest();
+		void keywordTest();
+		void parallelTest();
+		void tokenPoolTest();
+		void rollbackTest();
+		void retokenizeTest();
+		void sessionTest();
 		
 	private:
 		typedef ParsingTree::Token Token;